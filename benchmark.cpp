@@ -0,0 +1,194 @@
+#include "benchmark.h"
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#ifdef _WIN32
+#define PSAPI_VERSION 2 // GetProcessMemoryInfo from kernel32, no psapi import library needed
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+string WorkloadSpec::name() const
+{
+    ostringstream out;
+    out << workloadNames[kind];
+    if (kind == WORKLOAD_BRANCH)
+    {
+        out << "-" << (int)(takenRate * 100 + 0.5);
+    }
+    return out.str();
+}
+
+static Instruction makeInstruction(Opcode op, int rA, int rB, int rC, int imm = 0, int offset = 0, int target = -1)
+{
+    Instruction instr;
+    instr.op = op;
+    instr.rA = rA;
+    instr.rB = rB;
+    instr.rC = rC;
+    instr.imm = imm;
+    instr.offset = offset;
+    instr.target = target;
+    return instr;
+}
+
+// R2 holds the trip count and R3 the trip index, which memory bodies also use as their base
+void generateWorkload(const WorkloadSpec &spec, vector<Instruction> &program, PagedMemory &memory)
+{
+    const int patternBase = 1 << 20; // BEQ outcomes, one word per trip
+    const int sourceBase = 1 << 22;  // Streamed through by the memory body
+    const int destinationBase = 1 << 23;
+
+    program.clear();
+    memory.clear();
+    program.push_back(makeInstruction(OP_ADDI, 2, 0, 0, spec.iterations));
+    int loop = (int)program.size();
+
+    switch (spec.kind)
+    {
+    case WORKLOAD_CHAIN:
+        for (int k = 0; k < spec.bodyLength; ++k)
+        {
+            program.push_back(makeInstruction(OP_ADDI, 4, 4, 0, 1));
+        }
+        break;
+    case WORKLOAD_INDEPENDENT:
+        for (int k = 0; k < spec.bodyLength; ++k)
+        {
+            program.push_back(makeInstruction(OP_ADDI, 4 + k % 4, 0, 0, k));
+        }
+        break;
+    case WORKLOAD_MUL:
+        for (int k = 0; k < spec.bodyLength; ++k)
+        {
+            program.push_back(makeInstruction(OP_MUL, k % 2 == 0 ? 4 : 5, 6, 6)); // R6 starts at 4
+        }
+        break;
+    case WORKLOAD_MEMORY:
+        for (int k = 0; k + 1 < spec.bodyLength; k += 2)
+        {
+            program.push_back(makeInstruction(OP_LOAD, 4 + k % 4, 3, 0, 0, sourceBase + k));
+            program.push_back(makeInstruction(OP_STORE, 4 + k % 4, 3, 0, 0, destinationBase + k));
+        }
+        break;
+    case WORKLOAD_BRANCH:
+    {
+        // LOAD the trip's pattern word and skip the ADDI when it is zero
+        int branch = loop + 1;
+        program.push_back(makeInstruction(OP_LOAD, 4, 3, 0, 0, patternBase));
+        program.push_back(makeInstruction(OP_BEQ, 4, 0, 0, 0, 0, branch + 2));
+        program.push_back(makeInstruction(OP_ADDI, 5, 5, 0, 1));
+
+        uint32_t seed = 12345; // Fixed, so every run replays the same outcomes
+        for (int trip = 0; trip < spec.iterations; ++trip)
+        {
+            seed = seed * 1103515245u + 12345u;
+            memory.write(patternBase + trip, (seed >> 8) % 10000 < spec.takenRate * 10000 ? 0 : 1);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+
+    // Count the trip and close the loop
+    program.push_back(makeInstruction(OP_ADDI, 3, 3, 0, 1));
+    int exit = (int)program.size();
+    program.push_back(makeInstruction(OP_BEQ, 3, 2, 0, 0, 0, exit + 2));
+    program.push_back(makeInstruction(OP_BEQ, 0, 0, 0, 0, 0, loop));
+}
+
+long long peakMemoryKB()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return -1;
+    }
+    return (long long)(counters.PeakWorkingSetSize / 1024);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+    {
+        return -1;
+    }
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; // Bytes on macOS
+#else
+    return usage.ru_maxrss; // KiB on Linux
+#endif
+#endif
+}
+
+// Runs every workload of the suite and writes one CSV row each with simulator throughput
+bool runBenchmark(int iterations, const string &outputFilename, bool detailedStats)
+{
+    ofstream out(outputFilename);
+    if (!out)
+    {
+        cerr << "Error: Could not open benchmark output file!" << endl;
+        return false;
+    }
+
+    // A moderately wide machine, so issue, execute and commit all do real work every cycle
+    HardwareConfig config;
+    config.robEntries = 32;
+    config.issueWidth = 2;
+    config.commitWidth = 2;
+    config.predictor = PREDICTOR_BIMODAL;
+    config.btbEntries = 64;
+    config.rasDepth = 8;
+
+    vector<WorkloadSpec> suite;
+    for (int kind = 0; kind < WORKLOAD_BRANCH; ++kind)
+    {
+        WorkloadSpec spec;
+        spec.kind = (WorkloadKind)kind;
+        spec.iterations = iterations;
+        suite.push_back(spec);
+    }
+    for (double rate : {0.1, 0.5, 0.9})
+    {
+        WorkloadSpec spec;
+        spec.kind = WORKLOAD_BRANCH;
+        spec.iterations = iterations;
+        spec.takenRate = rate;
+        suite.push_back(spec);
+    }
+
+    const char *stats = detailedStats ? "detailed" : "lean";
+    out << "workload,stats,iterations,instructions,cycles,ipc,seconds,instructions_per_second,cycles_per_second,"
+           "peak_memory_kb\n";
+    for (const auto &spec : suite)
+    {
+        vector<Instruction> program;
+        PagedMemory memoryImage;
+        generateWorkload(spec, program, memoryImage);
+
+        Simulator simulator;
+        simulator.detailedStats = detailedStats;
+        simulator.load(program, memoryImage, config);
+        auto start = chrono::steady_clock::now();
+        simulator.run();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        long long instructions = simulator.committedInstructions();
+        long long cycles = simulator.cycles();
+        double instructionRate = seconds > 0 ? instructions / seconds : 0.0;
+        double cycleRate = seconds > 0 ? cycles / seconds : 0.0;
+        long long peak = peakMemoryKB(); // Of the process, so it never drops between workloads
+
+        out << spec.name() << "," << stats << "," << spec.iterations << "," << instructions << "," << cycles << ","
+            << simulator.ipc() << "," << seconds << "," << (long long)instructionRate << "," << (long long)cycleRate
+            << "," << peak << "\n";
+        cout << spec.name() << " (" << stats << "): " << instructions << " instructions, " << cycles << " cycles in " << seconds
+             << " s (" << (long long)instructionRate << " instructions/s, " << (long long)cycleRate << " cycles/s), peak "
+             << peak << " KiB" << endl;
+    }
+    return (bool)out;
+}
@@ -0,0 +1,39 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "tomasulo.h"
+
+// Synthetic program shapes, each a counted loop around a generated body
+enum WorkloadKind
+{
+    WORKLOAD_CHAIN,       // One long dependency chain of ADDIs
+    WORKLOAD_INDEPENDENT, // ADDIs with no dependences between them
+    WORKLOAD_MUL,         // Independent MULs
+    WORKLOAD_MEMORY,      // LOAD/STORE pairs streaming through memory
+    WORKLOAD_BRANCH,      // Data-dependent BEQ taken at a chosen rate
+    WORKLOAD_COUNT
+};
+
+const char *const workloadNames[] = {"chain", "independent", "mul", "memory", "branch"};
+
+struct WorkloadSpec
+{
+    WorkloadKind kind = WORKLOAD_CHAIN;
+    int iterations = 100000; // Loop trips
+    int bodyLength = 16;     // Generated instructions per trip (the branch body is fixed)
+    double takenRate = 0.5;  // WORKLOAD_BRANCH: fraction of trips on which the BEQ is taken
+
+    std::string name() const;
+};
+
+// Builds the program and its initial memory
+void generateWorkload(const WorkloadSpec &spec, std::vector<Instruction> &program, PagedMemory &memory);
+
+// Peak resident memory of the whole process so far, in KiB, or -1 where unsupported
+long long peakMemoryKB();
+
+// Runs every workload of the suite and writes one CSV row each with simulator throughput;
+// detailedStats picks the core with or without cycle accounting and the per-PC profile
+bool runBenchmark(int iterations, const std::string &outputFilename, bool detailedStats = true);
+
+#endif
@@ -0,0 +1,205 @@
+#include "image.h"
+#include <fstream>
+#include <cstring>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+MappedImage::MappedImage(const string &filename)
+{
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+    file = handle;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart < (LONGLONG)sizeof(ImageHeader))
+    {
+        unmap();
+        return;
+    }
+    size = (size_t)fileSize.QuadPart;
+
+    mapping = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL)
+    {
+        unmap();
+        return;
+    }
+    data = (const char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == NULL)
+    {
+        unmap();
+        return;
+    }
+#else
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+        return;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size >= (off_t)sizeof(ImageHeader))
+    {
+        size = (size_t)info.st_size;
+        void *view = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        data = view == MAP_FAILED ? nullptr : (const char *)view;
+    }
+    close(fd); // The mapping keeps the file contents alive
+    if (data == nullptr)
+    {
+        return;
+    }
+#endif
+
+    // Reject anything that is not exactly a header plus count records
+    const ImageHeader &h = header();
+    if (memcmp(h.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) != 0 || h.version != IMAGE_VERSION ||
+        size != sizeof(ImageHeader) + (size_t)h.count * sizeof(EncodedInstruction))
+    {
+        unmap();
+    }
+}
+
+MappedImage::~MappedImage()
+{
+    unmap();
+}
+
+void MappedImage::unmap()
+{
+#ifdef _WIN32
+    if (data != nullptr)
+    {
+        UnmapViewOfFile(data);
+    }
+    if (mapping != nullptr)
+    {
+        CloseHandle(mapping);
+    }
+    if (file != nullptr)
+    {
+        CloseHandle(file);
+    }
+    file = mapping = nullptr;
+#else
+    if (data != nullptr)
+    {
+        munmap((void *)data, size);
+    }
+#endif
+    data = nullptr;
+    size = 0;
+}
+
+bool isProgramImage(const string &filename)
+{
+    ifstream imageFile(filename, ios::binary);
+    char magic[sizeof(IMAGE_MAGIC)];
+    return imageFile.read(magic, sizeof(magic)) && memcmp(magic, IMAGE_MAGIC, sizeof(magic)) == 0;
+}
+
+bool assembleProgram(const vector<Instruction> &instructions, const string &filename)
+{
+    ofstream imageFile(filename, ios::binary);
+    if (!imageFile)
+    {
+        cerr << "Error: Could not open image file!" << endl;
+        return false;
+    }
+
+    ImageHeader header;
+    memcpy(header.magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+    header.version = IMAGE_VERSION;
+    header.count = (uint32_t)instructions.size();
+    imageFile.write((const char *)&header, sizeof(header));
+
+    for (const auto &instr : instructions)
+    {
+        if (instr.rA < 0 || instr.rA >= 8 || instr.rB < 0 || instr.rB >= 8 || instr.rC < 0 || instr.rC >= 8)
+        {
+            cerr << "Error: Register out of range in " << opTable[instr.op].name << " instruction" << endl;
+            return false;
+        }
+
+        EncodedInstruction record;
+        record.op = (uint8_t)instr.op;
+        record.rA = (uint8_t)instr.rA;
+        record.rB = (uint8_t)instr.rB;
+        record.rC = (uint8_t)instr.rC;
+        record.imm = instr.imm;
+        record.offset = instr.offset;
+        record.target = instr.target;
+        imageFile.write((const char *)&record, sizeof(record));
+    }
+
+    if (!imageFile)
+    {
+        cerr << "Error: Could not write image file!" << endl;
+        return false;
+    }
+    LOG(LOG_SUMMARY, "Assembled " << instructions.size() << " instructions into image: " << filename << endl);
+    return true;
+}
+
+bool loadProgramImage(vector<Instruction> &instructions, const string &filename)
+{
+    MappedImage image(filename);
+    if (!image.valid())
+    {
+        cerr << "Error: Could not map program image!" << endl;
+        return false;
+    }
+
+    uint32_t count = image.header().count;
+    const EncodedInstruction *records = image.records();
+    size_t first = instructions.size();
+    instructions.reserve(first + count);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const EncodedInstruction &record = records[i];
+        if (record.op >= OP_COUNT || record.rA >= 8 || record.rB >= 8 || record.rC >= 8)
+        {
+            cerr << "Error: Corrupt record " << i << " in program image" << endl;
+            instructions.resize(first);
+            return false;
+        }
+
+        Instruction instr;
+        instr.op = (Opcode)record.op;
+        instr.rA = record.rA;
+        instr.rB = record.rB;
+        instr.rC = record.rC;
+        instr.imm = record.imm;
+        instr.offset = record.offset;
+        instr.target = record.target;
+        instructions.push_back(instr);
+    }
+
+    LOG(LOG_SUMMARY, "Program image mapped successfully from file: " << filename << endl);
+    return true;
+}
+
+void loadProgram(vector<Instruction> &instructions, const string &filename)
+{
+    if (isProgramImage(filename))
+    {
+        loadProgramImage(instructions, filename);
+    }
+    else
+    {
+        loadInstructionsFromFile(instructions, filename);
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+
+#include "tomasulo.h"
+
+// One assembled instruction: operands encoded, BEQ/CALL target already resolved
+struct EncodedInstruction
+{
+    uint8_t op;     // Opcode
+    uint8_t rA;     // Registers
+    uint8_t rB;
+    uint8_t rC;
+    int32_t imm;    // Immediate value
+    int32_t offset; // Offset for memory operations
+    int32_t target; // Absolute BEQ/CALL target, or -1
+};
+
+static_assert(sizeof(EncodedInstruction) == 16, "Image records are 16 bytes wide");
+
+// Start of an image file; count records follow directly. All fields are in host byte order.
+struct ImageHeader
+{
+    char magic[8];     // IMAGE_MAGIC
+    uint32_t version;  // IMAGE_VERSION
+    uint32_t count;    // Number of instructions
+};
+
+const char IMAGE_MAGIC[8] = {'T', 'O', 'M', 'A', 'S', 'I', 'M', 'G'};
+const uint32_t IMAGE_VERSION = 1;
+
+// Read-only memory mapping of an image file, unmapped on destruction
+class MappedImage
+{
+public:
+    explicit MappedImage(const std::string &filename);
+    ~MappedImage();
+    MappedImage(const MappedImage &) = delete;
+    MappedImage &operator=(const MappedImage &) = delete;
+
+    // False if the file could not be mapped or is not a well-formed image
+    bool valid() const { return data != nullptr; }
+    const ImageHeader &header() const { return *(const ImageHeader *)data; }
+    const EncodedInstruction *records() const { return (const EncodedInstruction *)(data + sizeof(ImageHeader)); }
+
+private:
+    const char *data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void *file = nullptr;    // HANDLE of the open file
+    void *mapping = nullptr; // HANDLE of the file mapping
+#endif
+
+    void unmap();
+};
+
+// Whether the file starts with the image magic
+bool isProgramImage(const std::string &filename);
+
+// Writes a parsed program as a binary image
+bool assembleProgram(const std::vector<Instruction> &instructions, const std::string &filename);
+
+// Maps an image and decodes it into instructions
+bool loadProgramImage(std::vector<Instruction> &instructions, const std::string &filename);
+
+// Loads either an image or a text program, whichever the file holds
+void loadProgram(std::vector<Instruction> &instructions, const std::string &filename);
+
+#endif
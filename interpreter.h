@@ -0,0 +1,67 @@
+#ifndef INTERPRETER_H
+#define INTERPRETER_H
+
+#include "tomasulo.h"
+
+// Architectural effect of one executed instruction
+struct Outcome
+{
+    int next;    // Address of the next instruction
+    int address; // Effective address for LOAD/STORE, target for BEQ/CALL/RET, else -1
+    bool taken;  // BEQ outcome
+};
+
+// Executes the instruction at pc on the architectural state, with no timing at all.
+// Shared by the fast-forward interpreter and trace recording, so both follow the same path.
+inline Outcome executeInstruction(const Instruction &instr, int pc, std::vector<int> &registers, PagedMemory &memory)
+{
+    const OpInfo &info = opTable[instr.op];
+    Outcome outcome = {pc + 1, -1, false};
+    int destination = -1;
+    int value = 0;
+    switch (info.semantics)
+    {
+    case SEM_ADD:
+        value = (int)((unsigned)registers[instr.rB] + (unsigned)(info.shape == SHAPE_RRI ? instr.imm : registers[instr.rC]));
+        destination = instr.rA;
+        break;
+    case SEM_NAND:
+        value = ~(registers[instr.rB] & registers[instr.rC]);
+        destination = instr.rA;
+        break;
+    case SEM_MUL:
+        value = (int)((unsigned)registers[instr.rB] * (unsigned)registers[instr.rC]);
+        destination = instr.rA;
+        break;
+    case SEM_LOAD:
+        outcome.address = registers[instr.rB] + instr.offset;
+        value = memory.read(outcome.address);
+        destination = instr.rA;
+        break;
+    case SEM_STORE:
+        outcome.address = registers[instr.rB] + instr.offset;
+        memory.write(outcome.address, registers[instr.rA]);
+        break;
+    case SEM_BEQ:
+        outcome.address = instr.target;
+        outcome.taken = registers[instr.rA] == registers[instr.rB];
+        outcome.next = outcome.taken ? instr.target : outcome.next;
+        break;
+    case SEM_CALL:
+        value = pc + 1;
+        destination = 1; // R1 holds the return address
+        outcome.next = outcome.address = instr.target;
+        break;
+    case SEM_RET:
+        outcome.next = outcome.address = registers[1];
+        break;
+    }
+
+    if (destination > 0)
+    {
+        registers[destination] = value; // R0 stays 0
+    }
+    return outcome;
+}
+
+#endif
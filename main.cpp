@@ -1,804 +1,345 @@
-#include <iostream>
-#include <fstream>
-#include <map>
-#include <vector>
-#include <string>
-#include <sstream>
+#include "tomasulo.h"
+#include "sweep.h"
+#include "image.h"
+#include "trace.h"
+#include "sampling.h"
+#include "benchmark.h"
+#include "pipeview.h"
+#include <thread>
+#include <cstdlib>
+#include <cstdio>
+
 using namespace std;
 
-struct InstructionProgress
-{
-    int issuedCycle = -1;    // Cycle when the instruction was issued
-    int startExecCycle = -1; // Cycle when execution started
-    int endExecCycle = -1;   // Cycle when execution ended
-    int writeCycle = -1;     // Cycle when write-back occurred
-    int commitCycle = -1;    // Cycle when the instruction was committed
-};
-
-struct Instruction
-{
-    string opcode;  // Instructions in assembly
-    int rA, rB, rC; // Registers
-    int imm;        // Immediate value
-    string offset;  // Offset for memory operations
-    string label;
-    InstructionProgress progress;
-};
-
-struct ReservationStation
-{
-    string op;        // Operation type
-    int Vj, Vk;       // Values of source operands
-    int Qj, Qk;       // Tags for source operands (dependency management)
-    int result;       // Computed result
-    bool busy;        // Busy flag
-    int cyclesLeft;   // Remaining execution cycles
-    bool resultReady; // Result ready for write stage
-    int address;      // For LOAD/STORE operations
-    int robIndex;     // Associated ROB entry
-};
-
-struct ROBEntry
+// Asks for the default configuration or a custom one
+HardwareConfig promptHardwareConfig()
 {
-    int instructionID; // ID of the instruction in the program
-    string state;      // "Issue", "Execute", "Write", "Commit"
-    int destination;   // Register or memory address to write to
-    int value;         // Computed value
-    bool ready;        // Whether the value is ready
-    bool speculative;  // Indicates if the instruction was executed speculatively
-};
-vector<ROBEntry> reorderBuffer(6); // ROB with 6 entries
-vector<Instruction> instructions;
-
-map<string, int> availableReservationStations = {
-    {"LOAD", 2},
-    {"STORE", 1},
-    {"BEQ", 1},
-    {"CALL", 1},
-    {"RET", 1},
-    {"ADD", 4},
-    {"ADDI", 4},
-    {"NAND", 2},
-    {"MUL", 1}};
-
-map<string, int> operationCycles = {
-    {"LOAD", 6},
-    {"STORE", 6},
-    {"BEQ", 1},
-    {"CALL", 1},
-    {"RET", 1},
-    {"ADD", 2},
-    {"ADDI", 2},
-    {"NAND", 1},
-    {"MUL", 8}};
-
-vector<int> registers(8, 0);
-
-map<int, int> memory;
-vector<ReservationStation> reservationStations(12);
-map<string, int> labelAddresses;
-
-class tomasulo
-{
-public:
-    int totalCycles = 0;
-    int instructionsCompleted = 0;
-    int branchMispredictions = 0;
-    int totalBranches = 0;
-    int pc = 0;
-    int startingAfdress;
-
-    void initialize();
-    void displayMetrics();
-    void simulate(vector<Instruction> &instructions, vector<ReservationStation> &reservationStations, vector<ROBEntry> &reorderBuffer, int startingAddress);
-    void issue(Instruction instr, vector<ReservationStation> &reservationStations, vector<ROBEntry> &reorderBuffer);
-    void commit(vector<ReservationStation> &reservationStations, vector<ROBEntry> &rob);
-    void write(vector<ReservationStation> &reservationStations, vector<ROBEntry> &reorderBuffer);
-    void execute(vector<ReservationStation> &reservationStations, vector<ROBEntry> &rob);
-    bool allInstructionsCompleted();
-    void handleBranch(vector<ReservationStation> &reservationStations, vector<ROBEntry> &rob, int mispredictedBranchIndex);
-    int allocateROBEntry();
-    void setupHardware();
-};
-
-void tomasulo::initialize()
-{
-    for (auto &rs : reservationStations)
-    {
-        rs.busy = false;
-    }
-
-    for (auto &entry : reorderBuffer)
-    {
-        entry.instructionID = -1; // No instruction
-        entry.state = "Empty";
-        entry.destination = -1;
-        entry.value = 0;
-        entry.ready = false;
-    }
-
-    registers[6] = 4;
-}
+    int choice;
+    cout << "Would you like to use the default hardware configuration or set up your own?" << endl;
+    cout << "1. Default hardware" << endl;
+    cout << "2. Custom hardware" << endl;
+    cout << "Enter your choice (1 or 2): ";
+    cin >> choice;
 
-int tomasulo::allocateROBEntry()
-{
-    for (int i = 0; i < reorderBuffer.size(); ++i)
+    // Default configuration unless the user enters their own
+    HardwareConfig config;
+    if (choice == 2)
     {
-        if (reorderBuffer[i].state == "Empty")
+        // Custom configuration
+        for (int c = 0; c < RS_CLASS_COUNT; ++c)
         {
-            return i;
+            cout << "Enter number of reservation stations for " << rsClassTable[c].name << ": ";
+            cin >> config.stations[c];
+            config.stations[c] = max(1, min(config.stations[c], (int)StationPool::MAX_STATIONS));
         }
-    }
-    return -1; // No available ROB entry
-}
-
-void tomasulo::displayMetrics()
-{
-    // cout << "Total Cycles: " << totalCycles << endl;
-    cout << "Instructions Per Cycle (IPC): " << (double)instructionsCompleted / totalCycles << endl;
-    cout << "Branch Mispredictions: " << branchMispredictions << endl;
-
-    if (totalBranches > 0)
-    {
-        cout << "Branch Misprediction Rate: "
-             << (double)branchMispredictions / totalBranches * 100 << "%" << endl;
-    }
-    else
-    {
-        cout << "Branch Misprediction Rate: N/A (No branches encountered)" << endl;
-    }
 
-    cout << "\nFinal Register States:\n";
-    for (int i = 0; i < registers.size(); ++i)
-    {
-        cout << "R" << i << " = " << registers[i] << endl;
-    }
+        cout << "Enter number of ROB entries: ";
+        cin >> config.robEntries;
+        config.robEntries = max(1, config.robEntries);
 
-    // Display Memory Contents
-    cout
-        << "\nFinal Memory States:\n";
-    for (int i = 0; i < memory.size(); ++i)
-    {
-        cout << "Memory[" << i << "] = " << memory[i] << endl;
-    }
+        cout << "Enter issue width: ";
+        cin >> config.issueWidth;
+        config.issueWidth = max(1, config.issueWidth);
 
-    for (const auto &instr : instructions)
-    {
-        cout << instr.opcode << "   issued: "
-             << (instr.progress.issuedCycle == -1 ? "-" : to_string(instr.progress.issuedCycle)) << "   start exec: "
-             << (instr.progress.startExecCycle == -1 ? "-" : to_string(instr.progress.startExecCycle)) << "   end exec: "
-             << (instr.progress.endExecCycle == -1 ? "-" : to_string(instr.progress.endExecCycle)) << "  write:  "
-             << (instr.progress.writeCycle == -1 ? "-" : to_string(instr.progress.writeCycle)) << " commit:  "
-             << (instr.progress.commitCycle == -1 ? "-" : to_string(instr.progress.commitCycle)) << endl;
-    }
-}
+        cout << "Enter commit width: ";
+        cin >> config.commitWidth;
+        config.commitWidth = max(1, config.commitWidth);
 
-void tomasulo::simulate(vector<Instruction> &instructions, vector<ReservationStation> &reservationStations, vector<ROBEntry> &reorderBuffer, int startingAddress)
-{
-    int cycle = 0;
-    pc = startingAddress; // Initialize program counter with starting address
-    instructionsCompleted = 0;
+        cout << "Enter CDB width (0 for unlimited): ";
+        cin >> config.cdbWidth;
+        config.cdbWidth = max(0, config.cdbWidth);
 
-    while (true)
-    {
-        cycle++;
-        totalCycles++;
-        cout << "Cycle: " << cycle << ", PC: " << pc << endl;
-        // Step 1: Issue stage
-        if (pc < instructions.size())
+        int arbitration;
+        cout << "Enter CDB arbitration (";
+        for (int k = 0; k < CDB_ARBITRATION_COUNT; ++k)
         {
-            issue(instructions[pc], reservationStations, reorderBuffer);
-            instructions[pc].progress.issuedCycle = cycle;
-            pc++; // Move to the next instruction
+            cout << (k > 0 ? ", " : "") << k << " = " << cdbArbitrationNames[k];
         }
-        cout << "\n\n";
-        cycle++;
-        totalCycles++;
-        cout << "Cycle: " << cycle << ", PC: " << pc << endl;
-        // Step 2: Execute stage
-        if (instructions[pc - 1].progress.startExecCycle == -1 && totalCycles > instructions[pc - 1].progress.issuedCycle)
+        cout << "): ";
+        cin >> arbitration;
+        config.cdbArbitration = (CDBArbitration)max(0, min(arbitration, CDB_ARBITRATION_COUNT - 1));
+
+        int predictor;
+        cout << "Enter branch predictor (";
+        for (int k = 0; k < PREDICTOR_COUNT; ++k)
         {
-            instructions[pc - 1].progress.startExecCycle = totalCycles;
+            cout << (k > 0 ? ", " : "") << k << " = " << predictorNames[k];
         }
-        execute(reservationStations, reorderBuffer);
+        cout << "): ";
+        cin >> predictor;
+        config.predictor = (PredictorKind)max(0, min(predictor, PREDICTOR_COUNT - 1));
 
-        // cycle++;
-        // cout << "Cycle after execute: " << cycle << ", PC: " << pc << endl;
+        cout << "Enter predictor table size in bits: ";
+        cin >> config.predictorBits;
+        config.predictorBits = max(1, min(config.predictorBits, 24));
 
-        // Step 3: Write stage
-        // write(reservationStations, reorderBuffer);
+        cout << "Enter number of BTB entries (0 for none): ";
+        cin >> config.btbEntries;
+        config.btbEntries = max(0, config.btbEntries);
 
-        // cycle++;
-        // cout << "Cycle after write: " << cycle << ", PC: " << pc << endl;
-        // Step 4: Commit stage
-        // commit(reservationStations, reorderBuffer);
+        cout << "Enter return address stack depth (0 for none): ";
+        cin >> config.rasDepth;
+        config.rasDepth = max(0, config.rasDepth);
 
-        // Break condition: Exit when all instructions are completed
-        if (allInstructionsCompleted())
+        cout << "Enter number of load/store queue entries: ";
+        cin >> config.lsqEntries;
+        config.lsqEntries = max(1, config.lsqEntries);
+
+        // Now, prompt for the number of cycles for each functional unit
+        for (int op = 0; op < OP_COUNT; ++op)
         {
-            cout << "All instructions completed at cycle: " << totalCycles << endl;
-            break;
+            cout << "Enter number of cycles for " << opTable[op].name << ": ";
+            cin >> config.cycles[op];
         }
-    }
-
-    // Output performance metrics
-    displayMetrics();
-}
 
-void tomasulo::issue(Instruction instr, vector<ReservationStation> &reservationStations, vector<ROBEntry> &reorderBuffer)
-{
-    // Step 1: Allocate ROB entry
-    int robIndex = allocateROBEntry();
-    if (robIndex == -1)
-    {
-        cout << "ROB full, cannot issue instruction: " << instr.opcode << endl;
-        return;
-    }
-
-    // Step 2: Find an available reservation station
-    for (auto &rs : reservationStations)
-    {
-        if (!rs.busy) // Find an available (non-busy) reservation station
+        for (int c = 0; c < RS_CLASS_COUNT; ++c)
         {
-            rs.op = instr.opcode;
-            rs.busy = true;
-            rs.robIndex = robIndex;                        // Link to ROB entry
-            rs.cyclesLeft = operationCycles[instr.opcode]; // Assign remaining cycles
+            cout << "Enter number of functional units for " << rsClassTable[c].name << ": ";
+            cin >> config.units[c];
+            config.units[c] = max(1, config.units[c]);
 
-            // Step 3: Handle operands and dependencies
-            if (instr.opcode == "LOAD" || instr.opcode == "STORE")
-            {
-                int offset = stoi(instr.offset);
-                rs.address = registers[instr.rB] + offset;
-                if (instr.opcode == "STORE")
-                {
-                    rs.Vj = registers[instr.rA]; // Store value of rA into memory
-                    rs.Qj = -1;                  // Assume no dependency for now
-                }
-                else
-                {
-                    rs.Vj = registers[instr.rA];
-                    rs.Qj = -1; // No dependency for LOAD on this example
-                }
-            }
-            else if (instr.opcode == "BEQ")
-            {
-                rs.Vj = registers[instr.rA];
-                rs.Qj = -1; // Assume operand is ready
-                rs.Vk = registers[instr.rB];
-                rs.Qk = -1;                                 // Assume operand is ready
-                reorderBuffer[robIndex].speculative = true; // Mark speculative
-            }
-            else if (instr.opcode == "CALL")
-            {
-                rs.result = pc + 1 + instr.imm;            // Compute return address
-                reorderBuffer[robIndex].value = rs.result; // Save return address
-                reorderBuffer[robIndex].ready = true;      // Mark ready
-            }
-            else if (instr.opcode == "RET")
-            {
-                rs.result = registers[1]; // Return to address stored in R1
-            }
-            else
-            {
-                // Other ALU operations
-                rs.Vj = (reorderBuffer[instr.rB].ready ? registers[instr.rB] : 0);
-                rs.Qj = (reorderBuffer[instr.rB].ready ? -1 : instr.rB);
-
-                rs.Vk = (instr.opcode == "ADDI") ? instr.imm : (reorderBuffer[instr.rC].ready ? registers[instr.rC] : 0);
-                rs.Qk = (instr.opcode == "ADDI") ? -1 : (reorderBuffer[instr.rC].ready ? -1 : instr.rC);
-            }
-
-            // Step 4: Initialize ROB entry
-            reorderBuffer[robIndex].instructionID = instr.rA;
-            reorderBuffer[robIndex].destination = instr.rA; // Assume rA is the destination
-            reorderBuffer[robIndex].state = "Issue";
-            reorderBuffer[robIndex].ready = false;
-
-            // Set speculative flag for branch-related instructions
-            reorderBuffer[robIndex].speculative = (instr.opcode == "BEQ" || instr.opcode == "CALL" || instr.opcode == "RET");
-
-            cout << "Issued instruction: " << instr.opcode << " to ROB entry " << robIndex << endl;
-            return; // Exit after issuing the instruction
+            cout << "Enter initiation interval for " << rsClassTable[c].name << " (0 for unpipelined): ";
+            cin >> config.intervals[c];
+            config.intervals[c] = max(0, config.intervals[c]);
         }
     }
 
-    // If no reservation station is available, stall this instruction
-    cout << "No available reservation station for instruction: " << instr.opcode << endl;
+    return config;
 }
 
-void tomasulo::execute(vector<ReservationStation> &reservationStations, vector<ROBEntry> &rob)
+int main(int argc, char *argv[])
 {
-    for (auto &rs : reservationStations)
+    // Create an instance of the simulator
+    Simulator simulator;
+    vector<Instruction> program;
+    PagedMemory memoryImage;
+
+    vector<string> sweepArgs;    // grid, memory, instructions and output files
+    vector<string> assembleArgs; // instructions and image files
+    vector<string> recordArgs;   // memory, instructions and trace files
+    string traceFilename;        // Trace to replay instead of a program
+    long long traceLimit = 100000000;
+    int threads = max(1u, thread::hardware_concurrency());
+    int startingAddress = 0;
+    bool sampled = false;
+    bool profile = false; // Print the per-instruction hotspot listing after the metrics
+    bool lean = false;    // Drop the cycle accounting and profile for a faster run
+    string benchmarkFilename; // Benchmark results, if benchmarking
+    int benchmarkIterations = 200000;
+    SamplingPlan samplingPlan;
+    string pipeViewFilename; // Pipeline view to write, if any
+    PipeViewFormat pipeViewFormat = PIPEVIEW_KONATA;
+    PipelineView pipeView;
+
+    logLevel = LOG_SUMMARY; // The library is silent by default; --log= changes this
+    for (int i = 1; i < argc; ++i)
     {
-        cout << "RS op: " << rs.op << ", busy: " << rs.busy << ", resultReady: " << rs.resultReady
-             << ", cyclesLeft: " << rs.cyclesLeft << endl;
-
-        if (rs.busy)
+        string arg = argv[i];
+        if (arg == "--step")
         {
-            if (rs.Qj != -1) // Operand is not ready, fetch from ROB
-            {
-                rs.Vj = rob[rs.Qj].value;
-            }
-            if (rs.Qk != -1) // Operand is not ready, fetch from ROB
-            {
-                rs.Vk = rob[rs.Qk].value;
-            }
-            if (rs.cyclesLeft > 0)
-            {
-                rs.cyclesLeft--; // Decrement cycles
-            }
-
-            if (rs.cyclesLeft == 0 && !rs.resultReady)
-            {
-                // Perform the operation based on the instruction type
-                if (rs.op == "ADD")
-                {
-                    rs.result = rs.Vj + rs.Vk;
-                }
-                else if (rs.op == "ADDI")
-                {
-                    rs.result = rs.Vj + rs.Vk; // Vk is the immediate value
-                }
-                else if (rs.op == "NAND")
-                {
-                    rs.result = ~(rs.Vj & rs.Vk);
-                }
-                else if (rs.op == "MUL")
-                {
-                    rs.result = rs.Vj * rs.Vk;
-                }
-                else if (rs.op == "LOAD")
-                {
-                    rs.result = memory[rs.address];
-                }
-                else if (rs.op == "STORE")
-                {
-                    memory[rs.address] = rs.Vj; // Store value into memory
-                }
-                else if (rs.op == "BEQ")
-                {
-                    totalBranches++;
-                    if (rs.Vj == rs.Vk) // Branch condition
-                    {
-                        rs.result = 1; // Indicate branch taken
-                    }
-                    else
-                    {
-                        rs.result = 0; // Indicate branch not taken
-                    }
-                }
-                else if (rs.op == "CALL")
-                {
-                    rs.result = pc + 1; // Compute return address
-                }
-                else if (rs.op == "RET")
-                {
-                    rs.result = registers[1]; // Return to address in R1
-                }
-
-                // Mark the result as ready
-                rs.resultReady = true;
-
-                if (instructions[pc - 1].progress.endExecCycle == -1)
-                {
-                    instructions[pc - 1].progress.endExecCycle = totalCycles;
-                }
-                totalCycles++;
-
-                cout << "\n\n";
-                if (instructions[pc - 1].progress.writeCycle == -1 && totalCycles > instructions[pc].progress.endExecCycle)
-                {
-                    instructions[pc - 1].progress.writeCycle = totalCycles;
-                }
-
-                write(reservationStations, rob);
-                cout << "\n\n";
-                totalCycles++;
-                if (instructions[pc - 1].progress.commitCycle == -1 && totalCycles > instructions[pc].progress.writeCycle)
-                {
-                    instructions[pc - 1].progress.commitCycle = totalCycles;
-                }
-                commit(reservationStations, rob);
-            }
+            simulator.eventDriven = false; // Advance one cycle at a time
         }
-    }
-}
-
-void tomasulo::commit(vector<ReservationStation> &reservationStations, vector<ROBEntry> &rob)
-{
-    cout << "Cycle: " << totalCycles << endl;
-    for (int i = 0; i < rob.size(); ++i)
-    {
-        ROBEntry &entry = rob[i];
-        cout << "ROB entry " << i << ": state = " << entry.state << ", destination = " << entry.destination
-             << ", value = " << entry.value << ", ready = " << entry.ready << endl;
-
-        // Only commit if the instruction is ready and in the "Write" state
-        if (entry.ready && entry.state == "Write")
+        else if (arg.compare(0, 6, "--log=") == 0)
         {
-            // Check for branch misprediction (based on linked reservation station)
-            if (entry.speculative)
+            // off, summary, event or cycle; levels above TOMASULO_MAX_LOG_LEVEL are compiled out
+            const char *const levels[] = {"off", "summary", "event", "cycle"};
+            for (int level = LOG_OFF; level <= LOG_CYCLE; ++level)
             {
-                for (auto &rs : reservationStations)
+                if (arg.substr(6) == levels[level])
                 {
-                    if (rs.robIndex == i && rs.op == "BEQ")
-                    {
-                        // Check branch result in the reservation station
-                        if (rs.result == 1) // Branch was taken (misprediction for always-not-taken predictor)
-                        {
-                            branchMispredictions++;
-                            handleBranch(reservationStations, rob, i);
-                            return; // Stop further commits until rollback is handled
-                        }
-                    }
+                    logLevel = level;
                 }
             }
-
-            // Commit result to destination (for non-branch instructions)
-            if (entry.destination != -1) // Valid destination (not for STORE)
-            {
-                registers[entry.destination] = entry.value;
-                cout << "Committed result to R" << entry.destination << ": " << entry.value << endl;
-            }
-
-            // Free the associated reservation station
-            for (auto &rs : reservationStations)
-            {
-                if (rs.robIndex == i) // Match the ROB entry
-                {
-                    rs.busy = false;
-                    rs.resultReady = false;
-                    rs.robIndex = -1; // Clear the ROB linkage
-                    break;
-                }
-            }
-
-            // Mark ROB entry as committed
-            entry.state = "Commit";
-            entry.ready = false;
-            entry.speculative = false;
-
-            instructionsCompleted++;
         }
-    }
-}
-
-void tomasulo::write(vector<ReservationStation> &reservationStations, vector<ROBEntry> &reorderBuffer)
-{
-    cout << "Cycle: " << totalCycles << endl;
-    for (auto &rs : reservationStations)
-    {
-        if (rs.busy && rs.resultReady)
+        else if (arg == "--sweep" && i + 4 < argc)
         {
-            // Write result to ROB
-            reorderBuffer[rs.robIndex].value = rs.result;
-            reorderBuffer[rs.robIndex].ready = true;
-            reorderBuffer[rs.robIndex].state = "Write";
-
-            // Broadcast result on the CDB
-            for (auto &rsWaiting : reservationStations)
-            {
-                if (rsWaiting.Qj == rs.robIndex)
-                {
-                    rsWaiting.Vj = rs.result;
-                    rsWaiting.Qj = -1;
-                }
-                if (rsWaiting.Qk == rs.robIndex)
-                {
-                    rsWaiting.Vk = rs.result;
-                    rsWaiting.Qk = -1;
-                }
-            }
-
-            // Free reservation station
-            rs.busy = false;
-            rs.resultReady = false;
-
-            cout << "Wrote result for instruction in ROB entry " << rs.robIndex << endl;
+            sweepArgs.assign(argv + i + 1, argv + i + 5);
+            i += 4;
         }
-    }
-}
-
-bool tomasulo::allInstructionsCompleted()
-{
-    // Check reservation stations
-    for (const auto &rs : reservationStations)
-    {
-        if (rs.busy)
-            return false; // If any reservation station is busy, instructions are not completed
-    }
-
-    // Check ROB
-    for (const auto &entry : reorderBuffer)
-    {
-        if (entry.state != "Empty" && entry.state != "Commit")
-            return false; // If any ROB entry is still active, instructions are not completed
-    }
-
-    return true; // All instructions are completed
-}
-
-void tomasulo::handleBranch(vector<ReservationStation> &reservationStations, vector<ROBEntry> &rob, int mispredictedBranchIndex)
-{
-    cout << "Branch misprediction detected at ROB entry " << mispredictedBranchIndex << ". Rolling back..." << endl;
-
-    // Reset ROB entries for speculative instructions
-    for (int i = mispredictedBranchIndex + 1; i < rob.size(); ++i)
-    {
-        ROBEntry &entry = rob[i];
-        entry.instructionID = -1;
-        entry.state = "Empty";
-        entry.destination = -1;
-        entry.value = 0;
-        entry.ready = false;
-        entry.speculative = false; // Clear speculative flag
-    }
-
-    // Reset all reservation stations for speculative instructions
-    for (auto &rs : reservationStations)
-    {
-        if (rs.robIndex > mispredictedBranchIndex)
+        else if (arg == "--assemble" && i + 2 < argc)
         {
-            rs.busy = false;
-            rs.resultReady = false;
-            rs.robIndex = -1;
+            assembleArgs.assign(argv + i + 1, argv + i + 3);
+            i += 2;
         }
-    }
-
-    // Update PC to the correct branch target
-    for (auto &rs : reservationStations)
-    {
-        if (rs.robIndex == mispredictedBranchIndex && rs.op == "BEQ")
+        else if (arg == "--record-trace" && i + 3 < argc)
         {
-            if (rs.result == 1) // Branch taken
-            {
-                pc = rs.address; // Correct branch target
-                break;
-            }
-            else
-            {
-                pc = mispredictedBranchIndex + 1; // Next instruction (not taken)
-                break;
-            }
+            recordArgs.assign(argv + i + 1, argv + i + 4);
+            i += 3;
+        }
+        else if (arg.compare(0, 14, "--trace-limit=") == 0)
+        {
+            traceLimit = atoll(arg.c_str() + 14);
+        }
+        else if (arg == "--trace" && i + 1 < argc)
+        {
+            traceFilename = argv[++i];
+        }
+        else if (arg.compare(0, 10, "--threads=") == 0)
+        {
+            threads = max(1, atoi(arg.c_str() + 10));
+        }
+        else if (arg.compare(0, 8, "--start=") == 0)
+        {
+            startingAddress = atoi(arg.c_str() + 8);
+        }
+        else if (arg == "--profile")
+        {
+            profile = true;
+        }
+        else if (arg == "--lean")
+        {
+            lean = true;
+        }
+        else if (arg == "--benchmark" && i + 1 < argc)
+        {
+            benchmarkFilename = argv[++i];
+        }
+        else if (arg.compare(0, 19, "--bench-iterations=") == 0)
+        {
+            benchmarkIterations = max(1, atoi(arg.c_str() + 19));
+        }
+        else if ((arg == "--pipeview" || arg == "--pipeview-binary") && i + 1 < argc)
+        {
+            pipeViewFilename = argv[++i];
+            pipeViewFormat = arg == "--pipeview" ? PIPEVIEW_KONATA : PIPEVIEW_BINARY;
+        }
+        else if (arg.compare(0, 9, "--sample=") == 0)
+        {
+            // --sample=<fast-forward>,<window>[,<warm-up>] in instructions
+            sampled = sscanf(arg.c_str() + 9, "%lld,%lld,%lld", &samplingPlan.fastForward, &samplingPlan.window,
+                             &samplingPlan.warmup) >= 2;
         }
     }
 
-    cout << "Rollback complete. Execution resumed from corrected branch." << endl;
-}
-
-void loadMemoryFromFile(map<int, int> &memory, const string &filename)
-{
-    ifstream memoryFile(filename);
-    if (!memoryFile)
-    {
-        cerr << "Error: Could not open memory file!" << endl;
-        return;
-    }
-
-    int address, value;
-    while (memoryFile >> address >> value)
+    // Assemble only: --assemble <instructions> <image>; later runs accept the image as the instructions file
+    if (!assembleArgs.empty())
     {
-        memory[address] = value; // Load address-value pairs into memory
+        loadInstructionsFromFile(program, assembleArgs[0]);
+        return assembleProgram(program, assembleArgs[1]) ? 0 : 1;
     }
 
-    memoryFile.close();
-    cout << "Memory loaded successfully from file: " << filename << endl;
-}
-
-void loadInstructionsFromFile(vector<Instruction> &instructions, const string &filename)
-{
-    ifstream inputFile(filename);
-    if (!inputFile)
+    // Record a trace: --record-trace <memory> <instructions> <trace>, at most --trace-limit instructions
+    if (!recordArgs.empty())
     {
-        cerr << "Error: Could not open instructions file!" << endl;
-        return;
+        loadMemoryFromFile(memoryImage, recordArgs[0]);
+        loadProgram(program, recordArgs[1]);
+        return recordTrace(program, memoryImage, startingAddress, recordArgs[2], traceLimit) ? 0 : 1;
     }
 
-    string line;
-    int address = 0;
-
-    // First pass: Store label addresses and instructions
-    while (getline(inputFile, line))
+    // Trace-driven run: --trace <trace>; only the hardware is configured interactively
+    if (!traceFilename.empty())
     {
-        // Skip empty lines
-        if (line.empty())
-        {
-            continue;
-        }
-
-        // If the line ends with a colon, it's a label
-        if (line.back() == ':')
+        TraceReader trace;
+        if (!trace.open(traceFilename))
         {
-            string label = line.substr(0, line.length() - 1); // Remove the colon
-            labelAddresses[label] = address;                  // Store label and its address
+            return 1;
         }
-        else
-        {
-            Instruction instr;
-            stringstream ss(line);
-            ss >> instr.opcode >> instr.rA >> instr.rB >> instr.rC >> instr.imm >> instr.offset;
-
-            // Check for parsing errors
-            if (ss.fail())
-            {
-                cerr << "Error: Invalid instruction format in file at line: " << line << endl;
-                continue;
-            }
-
-            // Save the instruction and increment the address
-            instructions.push_back(instr);
-            address++; // Increment address for each instruction
-        }
-    }
-
-    // Second pass: Replace labels with their addresses
-    for (auto &instr : instructions)
-    {
-        if (instr.opcode == "BEQ") // Specifically handle BEQ label resolution
+        simulator.loadTrace(trace, promptHardwareConfig());
+        simulator.detailedStats = !lean || profile;
+        if (!pipeViewFilename.empty())
         {
-            if (labelAddresses.find(instr.offset) != labelAddresses.end())
-            {
-                instr.imm = labelAddresses[instr.offset]; // Replace label with its address
-                instr.offset = "";                        // Clear the label string now that it's replaced
-            }
-            else if (!instr.offset.empty())
+            if (!pipeView.open(pipeViewFilename, pipeViewFormat))
             {
-                cerr << "Error: Undefined label " << instr.offset << endl;
+                return 1;
             }
+            simulator.attachPipeView(&pipeView);
         }
-        else if (instr.opcode == "CALL") // Handle CALL label resolution
+        simulator.run();
+        pipeView.close();
+        simulator.displayMetrics();
+        if (profile)
         {
-            // Store the return address (next instruction address) in R1
-            instr.rA = 1;            // Let's say R1 holds the return address
-            instr.imm = address + 1; // The next instruction address is the return address
-            if (labelAddresses.find(instr.offset) != labelAddresses.end())
-            {
-                instr.offset = "";                       // Clear the label name as it's now resolved
-                instr.rB = labelAddresses[instr.offset]; // Jump to the label address
-            }
-            else if (!instr.offset.empty())
-            {
-                cerr << "Error: Undefined label " << instr.offset << endl;
-            }
+            simulator.displayProfile();
         }
+        return 0;
     }
 
-    inputFile.close();
-    cout << "Instructions loaded and parsed successfully from file: " << filename << endl;
-}
-
-void tomasulo::setupHardware()
-{
-    int choice;
-    cout << "Would you like to use the default hardware configuration or set up your own?" << endl;
-    cout << "1. Default hardware" << endl;
-    cout << "2. Custom hardware" << endl;
-    cout << "Enter your choice (1 or 2): ";
-    cin >> choice;
-
-    if (choice == 1)
-    {
-        // Default configuration
-        availableReservationStations = {
-            {"LOAD", 2},
-            {"STORE", 1},
-            {"BEQ", 1},
-            {"CALL", 1},
-            {"RET", 1},
-            {"ADD", 4},
-            {"ADDI", 4},
-            {"NAND", 2},
-            {"MUL", 1}};
-
-        operationCycles = {
-            {"LOAD", 6},
-            {"STORE", 6},
-            {"BEQ", 1},
-            {"CALL", 1},
-            {"RET", 1},
-            {"ADD", 2},
-            {"ADDI", 2},
-            {"NAND", 1},
-            {"MUL", 8}};
-    }
-    else if (choice == 2)
+    // Simulator throughput on the synthetic suite: --benchmark <output.csv>, --bench-iterations trips per workload,
+    // --lean to time the core without cycle accounting
+    if (!benchmarkFilename.empty())
     {
-        // Custom configuration
-        cout << "Enter number of reservation stations for LOAD: ";
-        cin >> availableReservationStations["LOAD"];
-        cout << "Enter number of reservation stations for STORE: ";
-        cin >> availableReservationStations["STORE"];
-        cout << "Enter number of reservation stations for BEQ: ";
-        cin >> availableReservationStations["BEQ"];
-        cout << "Enter number of reservation stations for CALL: ";
-        cin >> availableReservationStations["CALL"];
-        cout << "Enter number of reservation stations for RET: ";
-        cin >> availableReservationStations["RET"];
-        cout << "Enter number of reservation stations for ADD: ";
-        cin >> availableReservationStations["ADD"];
-        cout << "Enter number of reservation stations for ADDI: ";
-        cin >> availableReservationStations["ADDI"];
-        cout << "Enter number of reservation stations for NAND: ";
-        cin >> availableReservationStations["NAND"];
-        cout << "Enter number of reservation stations for MUL: ";
-        cin >> availableReservationStations["MUL"];
+        int level = logLevel;
+        logLevel = LOG_OFF; // Completion messages would interleave with the report
+        bool ok = runBenchmark(benchmarkIterations, benchmarkFilename, !lean);
+        logLevel = level;
 
-        cout << "Enter number of ROB entries: ";
-        int robEntries;
-        cin >> robEntries;
-
-        // Initialize ROB with user-defined entries
-        vector<ROBEntry> reorderBuffer(robEntries);
-
-        // Now, prompt for the number of cycles for each functional unit
-        cout << "Enter number of cycles for LOAD: ";
-        cin >> operationCycles["LOAD"];
-        cout << "Enter number of cycles for STORE: ";
-        cin >> operationCycles["STORE"];
-        cout << "Enter number of cycles for BEQ: ";
-        cin >> operationCycles["BEQ"];
-        cout << "Enter number of cycles for CALL: ";
-        cin >> operationCycles["CALL"];
-        cout << "Enter number of cycles for RET: ";
-        cin >> operationCycles["RET"];
-        cout << "Enter number of cycles for ADD: ";
-        cin >> operationCycles["ADD"];
-        cout << "Enter number of cycles for ADDI: ";
-        cin >> operationCycles["ADDI"];
-        cout << "Enter number of cycles for NAND: ";
-        cin >> operationCycles["NAND"];
-        cout << "Enter number of cycles for MUL: ";
-        cin >> operationCycles["MUL"];
+        if (ok)
+        {
+            LOG(LOG_SUMMARY, "Benchmark results written to " << benchmarkFilename << endl);
+        }
+        return ok ? 0 : 1;
     }
 
-    // Initialize reservation stations based on available reservation stations
-    for (auto &entry : availableReservationStations)
+    // Design-space sweep: --sweep <grid> <memory> <instructions> <output.csv>
+    if (!sweepArgs.empty())
     {
-        int numStations = entry.second;
-        for (int i = 0; i < numStations; ++i)
+        vector<SweepAxis> axes;
+        if (!loadSweepGrid(axes, sweepArgs[0]))
         {
-            ReservationStation rs;
-            rs.op = entry.first;
-            rs.busy = false;
-            rs.cyclesLeft = operationCycles[entry.first];
-            reservationStations.push_back(rs);
+            return 1;
         }
-    }
-}
+        loadMemoryFromFile(memoryImage, sweepArgs[1]);
+        loadProgram(program, sweepArgs[2]);
 
-int main()
-{
-    // Create an instance of the simulator
-    tomasulo simulator;
+        int level = logLevel;
+        logLevel = LOG_OFF; // Workers would interleave their output
+        bool ok = runSweep(axes, program, memoryImage, startingAddress, threads, sweepArgs[3]);
+        logLevel = level;
 
-    // Initialize memory and instructions
-    // map<int, int> memory;
-    // vector<Instruction> instructions;
+        if (ok)
+        {
+            LOG(LOG_SUMMARY, "Sweep results written to " << sweepArgs[3] << endl);
+        }
+        return ok ? 0 : 1;
+    }
 
     // Step 1: Load memory values from a file
     string memoryFilename;
     cout << "Enter the name of the memory file: ";
     cin >> memoryFilename;
-    loadMemoryFromFile(memory, memoryFilename);
+    loadMemoryFromFile(memoryImage, memoryFilename);
 
     // Step 2: Load program instructions from a file
     string instructionsFilename;
     cout << "Enter the name of the instructions file: ";
     cin >> instructionsFilename;
-    loadInstructionsFromFile(instructions, instructionsFilename);
+    loadProgram(program, instructionsFilename);
 
     // Step 3: Ask for the starting address
-    int startingAddress;
     cout << "Enter the starting address of the program: ";
     cin >> startingAddress;
 
     // Step 4: Initialize the simulator with default or user input
-    simulator.initialize();
-    simulator.setupHardware();
+    simulator.load(program, memoryImage, promptHardwareConfig(), startingAddress);
+    simulator.detailedStats = !lean || profile; // --lean skips the CPI stack unless --profile needs the bookkeeping
+
+    // Pipeline view: --pipeview <file> for the Konata viewer, --pipeview-binary <file> for raw events
+    if (!pipeViewFilename.empty())
+    {
+        if (!pipeView.open(pipeViewFilename, pipeViewFormat))
+        {
+            return 1;
+        }
+        simulator.attachPipeView(&pipeView);
+    }
 
-    // Step 5: Execute the simulation
-    simulator.simulate(instructions, reservationStations, reorderBuffer, startingAddress);
+    // Step 5: Execute the simulation, in full or sampled
+    if (sampled)
+    {
+        displaySamplingReport(runSampled(simulator, samplingPlan));
+    }
+    else
+    {
+        simulator.run();
+    }
+    pipeView.close();
+
+    // Output performance metrics
+    simulator.displayMetrics();
+    if (profile)
+    {
+        simulator.displayProfile();
+    }
 
     return 0;
 }
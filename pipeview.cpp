@@ -0,0 +1,170 @@
+#include "pipeview.h"
+#include "tomasulo.h"
+#include <charconv>
+#include <chrono>
+#include <cstring>
+
+using namespace std;
+
+PipelineView::~PipelineView()
+{
+    close();
+}
+
+bool PipelineView::open(const string &filename, PipeViewFormat viewFormat)
+{
+    format = viewFormat;
+    file.open(filename, format == PIPEVIEW_BINARY ? ios::binary : ios::out);
+    if (!file)
+    {
+        cerr << "Error: Could not open pipeline view file!" << endl;
+        return false;
+    }
+
+    if (format == PIPEVIEW_BINARY)
+    {
+        PipeViewHeader header = {};
+        memcpy(header.magic, PIPEVIEW_MAGIC, sizeof(PIPEVIEW_MAGIC));
+        header.version = PIPEVIEW_VERSION;
+        file.write((const char *)&header, sizeof(header));
+    }
+    else
+    {
+        file << "Kanata\t0004\n";
+    }
+
+    writer = thread(&PipelineView::drain, this);
+    LOG(LOG_SUMMARY, "Writing pipeline view to file: " << filename << endl);
+    return true;
+}
+
+bool PipelineView::close()
+{
+    if (!writer.joinable())
+    {
+        return (bool)file;
+    }
+    closing.store(true, memory_order_release);
+    writer.join();
+    file.close();
+    return !file.fail();
+}
+
+// Writer thread: formats events until the simulation closes the view and the queue runs dry
+void PipelineView::drain()
+{
+    PipeEvent event;
+    for (;;)
+    {
+        if (queue.pop(event))
+        {
+            writeEvent(event);
+            continue;
+        }
+        if (closing.load(memory_order_acquire))
+        {
+            // Every push happened before closing was set, so whatever is left is all there is
+            while (queue.pop(event))
+            {
+                writeEvent(event);
+            }
+            break;
+        }
+        this_thread::sleep_for(chrono::microseconds(50));
+    }
+    file.write(buffer.data(), buffer.size());
+    buffer.clear();
+}
+
+// Formatted by hand into a buffer: a full run produces hundreds of megabytes of text
+void PipelineView::append(int64_t value)
+{
+    char digits[24];
+    char *end = to_chars(digits, digits + sizeof(digits), value).ptr;
+    buffer.append(digits, end);
+}
+
+void PipelineView::appendStage(char command, int64_t id, const char *stage)
+{
+    buffer += command;
+    buffer += '\t';
+    append(id);
+    buffer += "\t0\t";
+    buffer += stage;
+    buffer += '\n';
+}
+
+// Stages in the viewer: Is (waiting in a station), Ex, Wb (waiting for the CDB), Cm (waiting to retire)
+void PipelineView::writeEvent(const PipeEvent &event)
+{
+    if (format == PIPEVIEW_BINARY)
+    {
+        buffer.append((const char *)&event, sizeof(event));
+    }
+    else
+    {
+        if (cycle == -1)
+        {
+            buffer += "C=\t";
+            append(event.cycle);
+            buffer += '\n';
+        }
+        else if (event.cycle > cycle)
+        {
+            buffer += "C\t";
+            append(event.cycle - cycle);
+            buffer += '\n';
+        }
+        cycle = event.cycle;
+
+        int64_t id = event.sequence;
+        switch (event.kind)
+        {
+        case PIPE_ISSUE:
+            buffer += "I\t";
+            append(id);
+            buffer += '\t';
+            append(id);
+            buffer += "\t0\nL\t";
+            append(id);
+            buffer += "\t0\t";
+            append(event.pc);
+            buffer += ": ";
+            buffer += event.op < OP_COUNT ? opTable[event.op].name : "?";
+            buffer += '\n';
+            appendStage('S', id, "Is");
+            break;
+        case PIPE_START_EXEC:
+            appendStage('E', id, "Is");
+            appendStage('S', id, "Ex");
+            break;
+        case PIPE_END_EXEC:
+            appendStage('E', id, "Ex");
+            appendStage('S', id, "Wb");
+            break;
+        case PIPE_WRITE:
+            appendStage('E', id, "Wb");
+            appendStage('S', id, "Cm");
+            break;
+        case PIPE_COMMIT:
+            appendStage('E', id, "Cm");
+            buffer += "R\t";
+            append(id);
+            buffer += '\t';
+            append(retired++);
+            buffer += "\t0\n";
+            break;
+        case PIPE_SQUASH:
+            buffer += "R\t";
+            append(id);
+            buffer += "\t0\t1\n";
+            break;
+        }
+    }
+
+    if (buffer.size() >= (1 << 16))
+    {
+        file.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+}
@@ -0,0 +1,134 @@
+#ifndef PIPEVIEW_H
+#define PIPEVIEW_H
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum PipeEventKind : uint8_t
+{
+    PIPE_ISSUE,      // Entered the ROB and a reservation station
+    PIPE_START_EXEC, // Dispatched to a functional unit
+    PIPE_END_EXEC,   // Result computed
+    PIPE_WRITE,      // Result broadcast on the CDB
+    PIPE_COMMIT,     // Retired
+    PIPE_SQUASH      // Flushed before it could retire
+};
+
+// One pipeline event of one dynamic instruction
+struct PipeEvent
+{
+    int64_t cycle;    // Cycle the event happened in
+    int64_t sequence; // Dynamic instruction number, in issue order
+    int32_t pc;       // Address of the instruction
+    uint8_t kind;     // PipeEventKind
+    uint8_t op;       // Opcode
+    uint8_t reserved[2];
+};
+
+static_assert(sizeof(PipeEvent) == 24, "Pipeline events are 24 bytes wide");
+
+// Start of a binary pipeline view; events follow until end of file, in host byte order
+struct PipeViewHeader
+{
+    char magic[8];    // PIPEVIEW_MAGIC
+    uint32_t version; // PIPEVIEW_VERSION
+    uint32_t reserved;
+};
+
+const char PIPEVIEW_MAGIC[8] = {'T', 'O', 'M', 'A', 'S', 'P', 'I', 'P'};
+const uint32_t PIPEVIEW_VERSION = 1;
+
+// Bounded single-producer single-consumer ring. Each side owns one index and only reads the
+// other's, so neither needs a lock; the indices sit on separate cache lines.
+template <typename T>
+class SpscQueue
+{
+public:
+    explicit SpscQueue(size_t capacityLog2) : slots(size_t(1) << capacityLog2), mask(slots.size() - 1) {}
+
+    // False if the queue is full
+    bool push(const T &item)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == slots.size())
+        {
+            return false;
+        }
+        slots[t & mask] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // False if the queue is empty
+    bool pop(T &item)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        item = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::vector<T> slots;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head{0}; // Next slot to pop, written by the consumer
+    alignas(64) std::atomic<size_t> tail{0}; // Next slot to push, written by the producer
+};
+
+enum PipeViewFormat
+{
+    PIPEVIEW_KONATA, // Kanata text log, opened by the Konata pipeline viewer
+    PIPEVIEW_BINARY  // PipeViewHeader followed by raw PipeEvents
+};
+
+// Streams pipeline events to a file. The simulation thread only pushes into a queue;
+// a background thread formats and writes, so a full-length run can be traced.
+class PipelineView
+{
+public:
+    PipelineView() = default;
+    ~PipelineView();
+    PipelineView(const PipelineView &) = delete;
+    PipelineView &operator=(const PipelineView &) = delete;
+
+    bool open(const std::string &filename, PipeViewFormat format);
+
+    // Called by the simulation thread; waits only while the writer is a full queue behind
+    void record(const PipeEvent &event)
+    {
+        while (!queue.push(event))
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // Drains the queue, stops the writer and closes the file; false if any write failed
+    bool close();
+
+private:
+    SpscQueue<PipeEvent> queue{16};
+    std::ofstream file;
+    PipeViewFormat format = PIPEVIEW_KONATA;
+    std::thread writer;
+    std::atomic<bool> closing{false};
+
+    // Writer thread state
+    int64_t cycle = -1;  // Cycle of the last event written
+    int64_t retired = 0; // Konata retire numbers
+    std::string buffer;  // Formatted output not yet written
+
+    void drain();
+    void writeEvent(const PipeEvent &event);
+    void append(int64_t value);
+    void appendStage(char command, int64_t id, const char *stage);
+};
+
+#endif
@@ -0,0 +1,241 @@
+#ifndef PREDICTOR_H
+#define PREDICTOR_H
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+enum PredictorKind
+{
+    PREDICTOR_NOT_TAKEN,  // Static: always fall through
+    PREDICTOR_TAKEN,      // Static: always taken
+    PREDICTOR_BTFN,       // Static: backward taken, forward not taken
+    PREDICTOR_BIMODAL,    // 2-bit counters indexed by PC
+    PREDICTOR_GSHARE,     // 2-bit counters indexed by PC xor global history
+    PREDICTOR_TOURNAMENT, // Bimodal and gshare with a per-PC chooser
+    PREDICTOR_COUNT
+};
+
+const char *const predictorNames[] = {"not-taken", "taken", "btfn", "bimodal", "gshare", "tournament"};
+
+// Direction predictor for BEQ: consulted when a branch issues, trained when it commits.
+// Predictors with global history shift predictions in speculatively; the core checkpoints
+// the history in every ROB entry and restores it when that entry causes a flush.
+class BranchPredictor
+{
+public:
+    virtual ~BranchPredictor() = default;
+    virtual bool predict(int pc, int target) const = 0;
+    virtual void update(int pc, uint32_t history, bool taken) = 0; // history: checkpoint from issue
+
+    virtual uint32_t history() const { return 0; }
+    virtual void speculate(bool) {}
+    virtual void restore(uint32_t) {}
+};
+
+class StaticPredictor : public BranchPredictor
+{
+public:
+    explicit StaticPredictor(PredictorKind kind) : kind(kind) {}
+
+    bool predict(int pc, int target) const override
+    {
+        return kind == PREDICTOR_TAKEN || (kind == PREDICTOR_BTFN && target <= pc);
+    }
+    void update(int, uint32_t, bool) override {}
+
+private:
+    PredictorKind kind;
+};
+
+// Table of saturating 2-bit counters; values 2 and 3 predict taken
+struct CounterTable
+{
+    std::vector<uint8_t> counters;
+    uint32_t mask;
+
+    explicit CounterTable(int bits) : counters(1u << bits, 1), mask((1u << bits) - 1) {}
+
+    bool taken(uint32_t index) const { return counters[index & mask] >= 2; }
+    void train(uint32_t index, bool taken)
+    {
+        uint8_t &counter = counters[index & mask];
+        counter = taken ? (counter < 3 ? counter + 1 : 3) : (counter > 0 ? counter - 1 : 0);
+    }
+};
+
+class BimodalPredictor : public BranchPredictor
+{
+public:
+    explicit BimodalPredictor(int bits) : table(bits) {}
+
+    bool predict(int pc, int) const override { return table.taken(pc); }
+    void update(int pc, uint32_t, bool taken) override { table.train(pc, taken); }
+
+private:
+    CounterTable table;
+};
+
+class GsharePredictor : public BranchPredictor
+{
+public:
+    explicit GsharePredictor(int bits) : table(bits) {}
+
+    bool predict(int pc, int) const override { return predictAt(pc, globalHistory); }
+    bool predictAt(int pc, uint32_t history) const { return table.taken(pc ^ history); }
+    void update(int pc, uint32_t history, bool taken) override { table.train(pc ^ history, taken); }
+
+    uint32_t history() const override { return globalHistory; }
+    void speculate(bool taken) override { globalHistory = ((globalHistory << 1) | (taken ? 1 : 0)) & table.mask; }
+    void restore(uint32_t history) override { globalHistory = history & table.mask; }
+
+private:
+    CounterTable table;
+    uint32_t globalHistory = 0; // Includes outcomes predicted for branches still in flight
+};
+
+class TournamentPredictor : public BranchPredictor
+{
+public:
+    explicit TournamentPredictor(int bits) : bimodal(bits), gshare(bits), chooser(bits) {}
+
+    bool predict(int pc, int target) const override
+    {
+        return chooser.taken(pc) ? gshare.predict(pc, target) : bimodal.predict(pc, target);
+    }
+    void update(int pc, uint32_t history, bool taken) override
+    {
+        bool local = bimodal.predict(pc, -1);
+        bool global = gshare.predictAt(pc, history);
+        if (local != global)
+        {
+            chooser.train(pc, global == taken); // Lean towards whichever was right
+        }
+        bimodal.update(pc, history, taken);
+        gshare.update(pc, history, taken);
+    }
+
+    uint32_t history() const override { return gshare.history(); }
+    void speculate(bool taken) override { gshare.speculate(taken); }
+    void restore(uint32_t history) override { gshare.restore(history); }
+
+private:
+    BimodalPredictor bimodal;
+    GsharePredictor gshare;
+    CounterTable chooser; // Taken = trust gshare
+};
+
+inline std::unique_ptr<BranchPredictor> makePredictor(PredictorKind kind, int bits)
+{
+    switch (kind)
+    {
+    case PREDICTOR_BIMODAL:
+        return std::unique_ptr<BranchPredictor>(new BimodalPredictor(bits));
+    case PREDICTOR_GSHARE:
+        return std::unique_ptr<BranchPredictor>(new GsharePredictor(bits));
+    case PREDICTOR_TOURNAMENT:
+        return std::unique_ptr<BranchPredictor>(new TournamentPredictor(bits));
+    default:
+        return std::unique_ptr<BranchPredictor>(new StaticPredictor(kind));
+    }
+}
+
+// Direct-mapped branch target buffer: taken BEQ, CALL and RET targets by PC
+class BranchTargetBuffer
+{
+public:
+    void resize(int size) { entries.assign(size, Entry()); }
+
+    // False on a miss or when the buffer has no entries; any target, even -1, can be cached
+    bool lookup(int pc, int &target) const
+    {
+        if (entries.empty())
+        {
+            return false;
+        }
+        const Entry &entry = entries[(uint32_t)pc % entries.size()];
+        target = entry.target;
+        return entry.pc == pc;
+    }
+
+    void update(int pc, int target)
+    {
+        if (!entries.empty())
+        {
+            entries[(uint32_t)pc % entries.size()] = {pc, target};
+        }
+    }
+
+private:
+    struct Entry
+    {
+        int pc = -1;     // Tag: address of the control instruction
+        int target = -1; // Last taken target
+    };
+    std::vector<Entry> entries;
+};
+
+// Circular return address stack: CALL pushes its return address at issue and RET pops its
+// predicted target. When full, a push overwrites the oldest entry.
+class ReturnAddressStack
+{
+public:
+    // State saved at issue; restoring top, depth and the top entry undoes wrong-path pushes and pops
+    struct Checkpoint
+    {
+        int top = 0;
+        int count = 0;
+        int value = -1;
+    };
+
+    void resize(int depth)
+    {
+        entries.assign(depth, -1);
+        top = count = 0;
+    }
+    bool enabled() const { return !entries.empty(); }
+
+    // False if the push overwrote the oldest entry
+    bool push(int address)
+    {
+        top = top + 1 == (int)entries.size() ? 0 : top + 1;
+        entries[top] = address;
+        if (count == (int)entries.size())
+        {
+            return false;
+        }
+        count++;
+        return true;
+    }
+
+    // Predicted return address, or -1 if the stack is empty (pushed addresses are never negative)
+    int pop()
+    {
+        if (count == 0)
+        {
+            return -1;
+        }
+        int address = entries[top];
+        top = top == 0 ? (int)entries.size() - 1 : top - 1;
+        count--;
+        return address;
+    }
+
+    Checkpoint checkpoint() const { return {top, count, enabled() ? entries[top] : -1}; }
+    void restore(const Checkpoint &saved)
+    {
+        top = saved.top;
+        count = saved.count;
+        if (enabled())
+        {
+            entries[top] = saved.value;
+        }
+    }
+
+private:
+    std::vector<int> entries;
+    int top = 0;   // Index of the most recent entry
+    int count = 0; // Valid entries
+};
+
+#endif
@@ -0,0 +1,91 @@
+#include "sampling.h"
+#include <cmath>
+
+using namespace std;
+
+// Two-sided 95% critical values of Student's t for 1 to 30 degrees of freedom
+static const double tCritical95[30] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                       2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                       2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+
+SamplingResult runSampled(Simulator &simulator, const SamplingPlan &plan)
+{
+    SamplingResult result;
+    while (!simulator.finished())
+    {
+        simulator.fastForward(plan.fastForward);
+
+        if (plan.warmup > 0)
+        {
+            long long start = simulator.committedInstructions();
+            simulator.runUntil([&](const Simulator &s)
+                               { return s.committedInstructions() >= start + plan.warmup; });
+        }
+
+        // Windows are measured in committed instructions; commit width may overshoot slightly
+        long long cycles = simulator.cycles();
+        long long instructions = simulator.committedInstructions();
+        simulator.runUntil([&](const Simulator &s)
+                           { return s.committedInstructions() >= instructions + plan.window; });
+
+        long long measured = simulator.committedInstructions() - instructions;
+        if (measured >= plan.window && measured > 0)
+        {
+            result.cpi.push_back((double)(simulator.cycles() - cycles) / measured);
+        }
+    }
+    result.fastForwarded = simulator.fastForwardedInstructions();
+    result.detailed = simulator.committedInstructions();
+
+    int n = (int)result.cpi.size();
+    if (n == 0)
+    {
+        return result;
+    }
+    double sum = 0.0;
+    for (double cpi : result.cpi)
+    {
+        sum += cpi;
+    }
+    result.meanCpi = sum / n;
+    if (n > 1)
+    {
+        double squares = 0.0;
+        for (double cpi : result.cpi)
+        {
+            squares += (cpi - result.meanCpi) * (cpi - result.meanCpi);
+        }
+        double t = n - 1 <= 30 ? tCritical95[n - 2] : 1.96;
+        result.halfWidth = t * sqrt(squares / (n - 1) / n);
+    }
+    return result;
+}
+
+void displaySamplingReport(const SamplingResult &result)
+{
+    long long total = result.fastForwarded + result.detailed;
+    cout << "Sampled Simulation: " << result.cpi.size() << " samples, " << result.detailed << " of " << total
+         << " instructions simulated in detail (" << (total > 0 ? (double)result.detailed / total * 100 : 0.0) << "%)"
+         << endl;
+    if (result.cpi.empty())
+    {
+        cout << "Estimated IPC: N/A (no complete sample window)" << endl;
+        return;
+    }
+
+    cout << "Estimated IPC: " << result.ipc();
+    if (result.cpi.size() > 1)
+    {
+        cout << " (95% confidence interval " << result.ipcLow() << " - ";
+        if (result.ipcHigh() > 0.0)
+        {
+            cout << result.ipcHigh();
+        }
+        else
+        {
+            cout << "unbounded";
+        }
+        cout << ")";
+    }
+    cout << endl;
+}
@@ -0,0 +1,32 @@
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#include "tomasulo.h"
+
+// Sampled simulation: fast-forward, refill the pipeline, measure, and repeat to the end of the program
+struct SamplingPlan
+{
+    long long fastForward = 1000000; // Instructions executed functionally before each sample
+    long long warmup = 0;            // Detailed instructions run before measuring, not measured
+    long long window = 10000;        // Detailed instructions measured per sample
+};
+
+struct SamplingResult
+{
+    std::vector<double> cpi;    // Cycles per instruction of each complete window
+    long long fastForwarded = 0;
+    long long detailed = 0;     // Instructions committed in detailed mode, warm-up included
+    double meanCpi = 0.0;
+    double halfWidth = 0.0;     // Of the 95% confidence interval on meanCpi
+
+    double ipc() const { return meanCpi > 0.0 ? 1.0 / meanCpi : 0.0; }
+    double ipcLow() const { return 1.0 / (meanCpi + halfWidth); }
+    double ipcHigh() const { return meanCpi > halfWidth ? 1.0 / (meanCpi - halfWidth) : 0.0; } // 0 = unbounded
+};
+
+// Runs a loaded program under the plan until it finishes or hits the cycle limit
+SamplingResult runSampled(Simulator &simulator, const SamplingPlan &plan);
+
+void displaySamplingReport(const SamplingResult &result);
+
+#endif
@@ -0,0 +1,300 @@
+#include "sweep.h"
+#include <fstream>
+#include <sstream>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+// Sets the named parameter, returns false if the name is unknown
+bool setSweepParameter(HardwareConfig &config, const string &name, int value)
+{
+    if (name == "rob")
+    {
+        config.robEntries = max(1, value);
+        return true;
+    }
+    if (name == "width.issue")
+    {
+        config.issueWidth = max(1, value);
+        return true;
+    }
+    if (name == "width.commit")
+    {
+        config.commitWidth = max(1, value);
+        return true;
+    }
+    if (name == "width.cdb")
+    {
+        config.cdbWidth = max(0, value);
+        return true;
+    }
+    if (name == "cdb.arbitration")
+    {
+        config.cdbArbitration = (CDBArbitration)max(0, min(value, CDB_ARBITRATION_COUNT - 1)); // Index into cdbArbitrationNames
+        return true;
+    }
+    if (name == "predictor")
+    {
+        config.predictor = (PredictorKind)max(0, min(value, PREDICTOR_COUNT - 1)); // Index into predictorNames
+        return true;
+    }
+    if (name == "predictor.bits")
+    {
+        config.predictorBits = max(1, min(value, 24));
+        return true;
+    }
+    if (name == "btb")
+    {
+        config.btbEntries = max(0, value);
+        return true;
+    }
+    if (name == "ras")
+    {
+        config.rasDepth = max(0, value);
+        return true;
+    }
+    if (name == "lsq")
+    {
+        config.lsqEntries = max(1, value);
+        return true;
+    }
+    for (int c = 0; c < RS_CLASS_COUNT; ++c)
+    {
+        if (name == string("rs.") + rsClassTable[c].name)
+        {
+            config.stations[c] = max(1, min(value, (int)StationPool::MAX_STATIONS));
+            return true;
+        }
+    }
+    for (int op = 0; op < OP_COUNT; ++op)
+    {
+        if (name == string("cycles.") + opTable[op].name)
+        {
+            config.cycles[op] = value;
+            return true;
+        }
+    }
+    for (int c = 0; c < RS_CLASS_COUNT; ++c)
+    {
+        if (name == string("fu.") + rsClassTable[c].name)
+        {
+            config.units[c] = max(1, value);
+            return true;
+        }
+        if (name == string("ii.") + rsClassTable[c].name)
+        {
+            config.intervals[c] = max(0, value);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Grid file: one "<parameter> <value> <value> ..." line per swept parameter, # starts a comment
+bool loadSweepGrid(vector<SweepAxis> &axes, const string &filename)
+{
+    ifstream gridFile(filename);
+    if (!gridFile)
+    {
+        cerr << "Error: Could not open sweep grid file!" << endl;
+        return false;
+    }
+
+    string line;
+    while (getline(gridFile, line))
+    {
+        line = line.substr(0, line.find('#'));
+        stringstream ss(line);
+        SweepAxis axis;
+        if (!(ss >> axis.name))
+        {
+            continue; // Blank or comment line
+        }
+
+        HardwareConfig probe;
+        if (!setSweepParameter(probe, axis.name, 1))
+        {
+            cerr << "Error: Unknown sweep parameter " << axis.name << endl;
+            return false;
+        }
+
+        int value;
+        while (ss >> value)
+        {
+            axis.values.push_back(value);
+        }
+        if (axis.values.empty())
+        {
+            cerr << "Error: No values given for sweep parameter " << axis.name << endl;
+            return false;
+        }
+        axes.push_back(axis);
+    }
+    return true;
+}
+
+// Decodes a point index of the Cartesian product (last axis varies fastest)
+HardwareConfig sweepPoint(const vector<SweepAxis> &axes, long long index)
+{
+    HardwareConfig config;
+    for (int a = (int)axes.size() - 1; a >= 0; --a)
+    {
+        long long n = axes[a].values.size();
+        setSweepParameter(config, axes[a].name, axes[a].values[index % n]);
+        index /= n;
+    }
+    return config;
+}
+
+// Work-stealing pool: each worker drains its own deque from the back and steals
+// from the front of the others once it runs dry
+class SweepPool
+{
+public:
+    SweepPool(int workers, long long tasks) : queues(workers)
+    {
+        // Contiguous blocks keep neighbouring grid points on one worker
+        for (int w = 0; w < workers; ++w)
+        {
+            for (long long t = tasks * w / workers; t < tasks * (w + 1) / workers; ++t)
+            {
+                queues[w].tasks.push_back(t);
+            }
+        }
+    }
+
+    // Next task for worker w, or -1 when every queue is empty
+    long long next(int w)
+    {
+        {
+            WorkQueue &own = queues[w];
+            lock_guard<mutex> lock(own.lock);
+            if (!own.tasks.empty())
+            {
+                long long task = own.tasks.back();
+                own.tasks.pop_back();
+                return task;
+            }
+        }
+        for (int k = 1; k < (int)queues.size(); ++k)
+        {
+            WorkQueue &victim = queues[(w + k) % queues.size()];
+            lock_guard<mutex> lock(victim.lock);
+            if (!victim.tasks.empty())
+            {
+                long long task = victim.tasks.front();
+                victim.tasks.pop_front();
+                return task;
+            }
+        }
+        return -1;
+    }
+
+private:
+    struct WorkQueue
+    {
+        mutex lock;
+        deque<long long> tasks;
+    };
+    vector<WorkQueue> queues;
+};
+
+// Simulates every grid point over one program and writes one CSV row per point
+bool runSweep(const vector<SweepAxis> &axes, const vector<Instruction> &program, const PagedMemory &memoryImage,
+              int startingAddress, int threads, const string &outputFilename)
+{
+    long long points = 1;
+    for (const auto &axis : axes)
+    {
+        points *= axis.values.size();
+    }
+
+    ofstream out(outputFilename);
+    if (!out)
+    {
+        cerr << "Error: Could not open sweep output file!" << endl;
+        return false;
+    }
+
+    threads = max(1, (int)min<long long>(threads, points));
+    vector<SweepResult> results(points); // Each slot is written by exactly one worker
+    SweepPool pool(threads, points);
+
+    auto worker = [&](int w)
+    {
+        for (long long point = pool.next(w); point != -1; point = pool.next(w))
+        {
+            // A fresh simulator per point: no state is shared between workers
+            Simulator simulator;
+            simulator.detailedStats = false; // Only totals reach the CSV
+            SweepResult &result = results[point];
+            result.config = sweepPoint(axes, point);
+            simulator.load(program, memoryImage, result.config, startingAddress);
+            simulator.run();
+
+            result.cycles = simulator.cycles();
+            result.instructions = simulator.committedInstructions();
+            result.branches = simulator.branches();
+            result.mispredictions = simulator.mispredictions();
+            result.flushes = simulator.predictionStats().flushes;
+            result.flushCycles = simulator.predictionStats().flushCycles;
+            result.cdbContentionCycles = simulator.cdbStats().contentionCycles;
+        }
+    };
+
+    vector<thread> workers;
+    for (int w = 1; w < threads; ++w)
+    {
+        workers.emplace_back(worker, w);
+    }
+    worker(0);
+    for (auto &t : workers)
+    {
+        t.join();
+    }
+
+    out << "point,rob,width.issue,width.commit,width.cdb,cdb.arbitration,predictor,predictor.bits,btb,ras,lsq";
+    for (int c = 0; c < RS_CLASS_COUNT; ++c)
+    {
+        out << ",rs." << rsClassTable[c].name;
+    }
+    for (int op = 0; op < OP_COUNT; ++op)
+    {
+        out << ",cycles." << opTable[op].name;
+    }
+    for (int c = 0; c < RS_CLASS_COUNT; ++c)
+    {
+        out << ",fu." << rsClassTable[c].name << ",ii." << rsClassTable[c].name;
+    }
+    out << ",total_cycles,instructions,ipc,branches,mispredictions,misprediction_rate,flushes,flush_cycles,cdb_contention_cycles\n";
+
+    for (long long point = 0; point < points; ++point)
+    {
+        const SweepResult &result = results[point];
+        out << point << "," << result.config.robEntries << "," << result.config.issueWidth << ","
+            << result.config.commitWidth << "," << result.config.cdbWidth << ","
+            << cdbArbitrationNames[result.config.cdbArbitration] << ","
+            << predictorNames[result.config.predictor] << "," << result.config.predictorBits << ","
+            << result.config.btbEntries << "," << result.config.rasDepth << "," << result.config.lsqEntries;
+        for (int c = 0; c < RS_CLASS_COUNT; ++c)
+        {
+            out << "," << result.config.stations[c];
+        }
+        for (int op = 0; op < OP_COUNT; ++op)
+        {
+            out << "," << result.config.cycles[op];
+        }
+        for (int c = 0; c < RS_CLASS_COUNT; ++c)
+        {
+            out << "," << result.config.units[c] << "," << result.config.intervals[c];
+        }
+        out << "," << result.cycles << "," << result.instructions << ","
+            << (result.cycles > 0 ? (double)result.instructions / result.cycles : 0.0) << ","
+            << result.branches << "," << result.mispredictions << ","
+            << (result.branches > 0 ? (double)result.mispredictions / result.branches : 0.0) << ","
+            << result.flushes << "," << result.flushCycles << "," << result.cdbContentionCycles << "\n";
+    }
+    return true;
+}
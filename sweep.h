@@ -0,0 +1,40 @@
+#ifndef SWEEP_H
+#define SWEEP_H
+
+#include "tomasulo.h"
+
+// One swept parameter and the values it takes
+struct SweepAxis
+{
+    std::string name;        // rob, width.<issue|commit|cdb>, cdb.arbitration, predictor[.bits], btb, ras, lsq, rs.<class>, fu.<class>, ii.<class> or cycles.<opcode>
+    std::vector<int> values; // Values tried, in file order
+};
+
+// Outcome of simulating one point of the grid
+struct SweepResult
+{
+    HardwareConfig config;
+    long long cycles = 0;
+    long long instructions = 0;
+    long long branches = 0;
+    long long mispredictions = 0;
+    long long flushes = 0;
+    long long flushCycles = 0;
+    long long cdbContentionCycles = 0;
+};
+
+// Sets the named parameter, returns false if the name is unknown
+bool setSweepParameter(HardwareConfig &config, const std::string &name, int value);
+
+// Grid file: one "<parameter> <value> <value> ..." line per swept parameter, # starts a comment
+bool loadSweepGrid(std::vector<SweepAxis> &axes, const std::string &filename);
+
+// Decodes a point index of the Cartesian product (last axis varies fastest)
+HardwareConfig sweepPoint(const std::vector<SweepAxis> &axes, long long index);
+
+// Simulates every grid point over one program and writes one CSV row per point
+bool runSweep(const std::vector<SweepAxis> &axes, const std::vector<Instruction> &program,
+              const PagedMemory &memoryImage, int startingAddress, int threads,
+              const std::string &outputFilename);
+
+#endif
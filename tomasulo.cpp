@@ -0,0 +1,1554 @@
+#include "tomasulo.h"
+#include "trace.h"
+#include "interpreter.h"
+#include "pipeview.h"
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <cstdlib>
+#include <iomanip>
+
+using namespace std;
+
+int logLevel = LOG_OFF; // Embedders stay silent unless they opt in; main raises it
+
+Opcode decodeOpcode(const string &mnemonic)
+{
+    for (int op = 0; op < OP_COUNT; ++op)
+    {
+        if (mnemonic == opTable[op].name)
+        {
+            return (Opcode)op;
+        }
+    }
+    return OP_INVALID;
+}
+
+static int destinationRegister(const Instruction &instr)
+{
+    int reg;
+    switch (opTable[instr.op].shape)
+    {
+    case SHAPE_RRR:
+    case SHAPE_RRI:
+    case SHAPE_LOAD:
+        reg = instr.rA;
+        break;
+    case SHAPE_CALL:
+        reg = 1; // Return address goes to R1
+        break;
+    default:
+        reg = -1;
+        break;
+    }
+    return reg == 0 ? -1 : reg;
+}
+
+// Brings every size into the range the core supports, the same limits the setup prompt enforces
+static HardwareConfig clampHardwareConfig(HardwareConfig config)
+{
+    for (int c = 0; c < RS_CLASS_COUNT; ++c)
+    {
+        config.stations[c] = max(1, min(config.stations[c], (int)StationPool::MAX_STATIONS));
+        config.units[c] = max(1, config.units[c]);
+        config.intervals[c] = max(0, config.intervals[c]);
+    }
+    config.robEntries = max(1, config.robEntries);
+    config.issueWidth = max(1, config.issueWidth);
+    config.commitWidth = max(1, config.commitWidth);
+    config.cdbWidth = max(0, config.cdbWidth);
+    config.cdbArbitration = (CDBArbitration)max(0, min((int)config.cdbArbitration, CDB_ARBITRATION_COUNT - 1));
+    config.predictor = (PredictorKind)max(0, min((int)config.predictor, PREDICTOR_COUNT - 1));
+    config.predictorBits = max(1, min(config.predictorBits, 24));
+    config.btbEntries = max(0, config.btbEntries);
+    config.rasDepth = max(0, config.rasDepth);
+    config.lsqEntries = max(1, config.lsqEntries);
+    return config;
+}
+
+void Simulator::load(const vector<Instruction> &program, const PagedMemory &memoryImage,
+                     const HardwareConfig &config, int startingAddress)
+{
+    instructions = program;
+    memory = memoryImage;
+    hardware = clampHardwareConfig(config);
+    operationCycles = hardware.cycles;
+
+    reorderBuffer.resize(hardware.robEntries);
+    reservationStations.resize(hardware.stations);
+    predictor = makePredictor(hardware.predictor, hardware.predictorBits);
+    btb.resize(hardware.btbEntries);
+    ras.resize(hardware.rasDepth);
+    loadStoreQueue.resize(hardware.lsqEntries);
+    initialize();
+
+    pc = startingAddress; // Initialize program counter with starting address
+}
+
+void Simulator::loadTrace(TraceReader &source, const HardwareConfig &config)
+{
+    // In-flight instructions are kept in the slot of their ROB entry, so the
+    // program array only needs to be as large as the ROB
+    load(vector<Instruction>(max(1, config.robEntries)), PagedMemory(), config);
+    trace = &source;
+    pcProfile.clear(); // Sized by the PCs the trace visits instead
+}
+
+void Simulator::initialize()
+{
+    reservationStations.releaseAll();
+
+    reorderBuffer.resize(reorderBuffer.size());
+    registers.assign(registers.size(), 0);
+    fill(registerStatus.begin(), registerStatus.end(), -1);
+    completionEvents = decltype(completionEvents)();
+    for (int c = 0; c < RS_CLASS_COUNT; ++c)
+    {
+        unitFreeCycle[c].assign(max(1, hardware.units[c]), 0);
+    }
+
+    totalCycles = 0;
+    instructionsCompleted = 0;
+    branchMispredictions = 0;
+    totalBranches = 0;
+    fastForwarded = 0;
+    prediction = PredictionStats();
+    loadStoreQueue.clear();
+    memoryCounters = MemoryStats();
+    cdbCounters = CDBStats();
+    pcProfile.assign(instructions.size(), PCProfile());
+    accounting = CycleAccounting();
+    accounting.robOccupancy.assign(reorderBuffer.size() + 1, 0);
+    for (int c = 0; c < RS_CLASS_COUNT; ++c)
+    {
+        accounting.stationOccupancy[c].assign(reservationStations.pools[c].size + 1, 0);
+    }
+    issueStall = commitStall = SLOT_FRONT_END;
+    trace = nullptr;
+    redirectPending = false;
+    sequence = 0;
+
+    registers[6] = 4;
+}
+
+void Simulator::displayMetrics() const
+{
+    // cout << "Total Cycles: " << totalCycles << endl;
+    cout << "Instructions Per Cycle (IPC): " << (double)instructionsCompleted / totalCycles << endl;
+    cout << "Branch Mispredictions: " << branchMispredictions << endl;
+
+    if (totalBranches > 0)
+    {
+        cout << "Branch Misprediction Rate: "
+             << (double)branchMispredictions / totalBranches * 100 << "%" << endl;
+    }
+    else
+    {
+        cout << "Branch Misprediction Rate: N/A (No branches encountered)" << endl;
+    }
+
+    cout << "Branch Predictor: " << predictorNames[hardware.predictor];
+    if (hardware.predictor >= PREDICTOR_BIMODAL)
+    {
+        cout << " (" << (1 << hardware.predictorBits) << " counters)";
+    }
+    cout << endl;
+    if (totalBranches > 0)
+    {
+        cout << "Direction Prediction Accuracy: "
+             << (1 - (double)prediction.directionMisses / totalBranches) * 100 << "%" << endl;
+    }
+    if (hardware.btbEntries > 0 && prediction.btbLookups > 0)
+    {
+        cout << "BTB Hit Rate: " << (double)prediction.btbHits / prediction.btbLookups * 100 << "% of "
+             << prediction.btbLookups << " lookups" << endl;
+    }
+    if (hardware.rasDepth > 0)
+    {
+        cout << "Return Address Stack: " << hardware.rasDepth << " entries, " << prediction.rasOverflows
+             << " overflows, " << prediction.rasUnderflows << " underflows" << endl;
+    }
+    cout << "CALL/RET Target Mispredictions: " << prediction.targetMisses << endl;
+    cout << "Pipeline Flushes: " << prediction.flushes << " (" << prediction.flushCycles
+         << " cycles fetching the wrong path)" << endl;
+    cout << "Common Data Bus: ";
+    if (hardware.cdbWidth > 0)
+    {
+        cout << hardware.cdbWidth << " buses (" << cdbArbitrationNames[hardware.cdbArbitration] << "), ";
+    }
+    else
+    {
+        cout << "unlimited, ";
+    }
+    cout << cdbCounters.broadcasts << " results broadcast, " << cdbCounters.saturatedCycles << " cycles saturated, "
+         << cdbCounters.contentionCycles << " cycles with results waiting (" << cdbCounters.deferredResults
+         << " result-cycles lost)" << endl;
+    cout << "Load/Store Queue: " << hardware.lsqEntries << " entries, " << memoryCounters.forwardedLoads
+         << " loads forwarded from stores, " << memoryCounters.bypassingLoads << " loads bypassed older stores" << endl;
+    if (detailedStats)
+    {
+        displayAccounting();
+    }
+
+    cout << "\nFinal Register States:\n";
+    for (int i = 0; i < registers.size(); ++i)
+    {
+        cout << "R" << i << " = " << registers[i] << endl;
+    }
+
+    // Display Memory Contents
+    cout
+        << "\nFinal Memory States:\n";
+    for (const auto &cell : memory)
+    {
+        cout << "Memory[" << cell.first << "] = " << cell.second << endl;
+    }
+
+    if (trace != nullptr)
+    {
+        return; // The per-instruction table only exists for static programs
+    }
+
+    for (const auto &instr : instructions)
+    {
+        cout << opTable[instr.op].name << "   issued: "
+             << (instr.progress.issuedCycle == -1 ? "-" : to_string(instr.progress.issuedCycle)) << "   start exec: "
+             << (instr.progress.startExecCycle == -1 ? "-" : to_string(instr.progress.startExecCycle)) << "   end exec: "
+             << (instr.progress.endExecCycle == -1 ? "-" : to_string(instr.progress.endExecCycle)) << "  write:  "
+             << (instr.progress.writeCycle == -1 ? "-" : to_string(instr.progress.writeCycle)) << " commit:  "
+             << (instr.progress.commitCycle == -1 ? "-" : to_string(instr.progress.commitCycle)) << endl;
+    }
+}
+
+void Simulator::profileCommit(const ROBEntry &entry)
+{
+    if (entry.pc < 0)
+    {
+        return;
+    }
+    if (entry.pc >= (int)pcProfile.size())
+    {
+        pcProfile.resize(entry.pc + 1); // Trace mode learns the program as it goes
+    }
+
+    PCProfile &profile = pcProfile[entry.pc];
+    profile.executions++;
+    profile.latencyCycles += totalCycles - entry.progress.issuedCycle;
+    if (entry.op == OP_BEQ && entry.value == 1)
+    {
+        profile.taken++;
+    }
+    if (entry.operandsReadyCycle != -1)
+    {
+        long long wait = entry.operandsReadyCycle - entry.progress.issuedCycle;
+        profile.operandWaitCycles += wait;
+
+        auto producer = profile.producers.begin();
+        while (producer != profile.producers.end() && producer->first != entry.producerPc)
+        {
+            ++producer;
+        }
+        if (producer == profile.producers.end())
+        {
+            profile.producers.push_back({entry.producerPc, wait});
+        }
+        else
+        {
+            producer->second += wait;
+        }
+    }
+}
+
+void Simulator::displayProfile() const
+{
+    long long totalLatency = 0;
+    for (const auto &profile : pcProfile)
+    {
+        totalLatency += profile.latencyCycles;
+    }
+
+    // Label definitions are not kept, so recover them from the instructions that name them
+    map<int, string> labels;
+    if (trace == nullptr)
+    {
+        for (const auto &instr : instructions)
+        {
+            if (!instr.label.empty() && instr.target != -1)
+            {
+                labels[instr.target] = instr.label;
+            }
+        }
+    }
+
+    ios::fmtflags flags = cout.flags();
+    streamsize precision = cout.precision();
+    cout << fixed << setprecision(1);
+
+    cout << "\nHotspot Profile (averages per execution; share of all issue-to-commit cycles):" << endl;
+    cout << "    PC  Executions  Share%  Latency  OperandWait  WaitsOn  Taken%  Instruction" << endl;
+    for (int pc = 0; pc < (int)pcProfile.size(); ++pc)
+    {
+        auto label = labels.find(pc);
+        if (label != labels.end())
+        {
+            cout << label->second << ":" << endl;
+        }
+
+        const PCProfile &profile = pcProfile[pc];
+        cout << setw(6) << pc << setw(12) << profile.executions;
+        if (profile.executions > 0)
+        {
+            int producer = profile.mainProducer();
+            cout << setw(8) << (totalLatency > 0 ? (double)profile.latencyCycles / totalLatency * 100 : 0.0)
+                 << setw(9) << (double)profile.latencyCycles / profile.executions << setw(13)
+                 << (double)profile.operandWaitCycles / profile.executions << setw(9)
+                 << (producer == -1 ? "-" : to_string(producer));
+        }
+        else
+        {
+            cout << setw(8) << "-" << setw(9) << "-" << setw(13) << "-" << setw(9) << "-";
+        }
+
+        // Only the in-flight part of a trace is ever decoded, so trace runs list PCs alone
+        bool branch = trace == nullptr ? instructions[pc].op == OP_BEQ : profile.taken > 0;
+        if (branch && profile.executions > 0)
+        {
+            cout << setw(8) << (double)profile.taken / profile.executions * 100;
+        }
+        else
+        {
+            cout << setw(8) << "-";
+        }
+        if (trace == nullptr)
+        {
+            const Instruction &instr = instructions[pc];
+            cout << "  " << opTable[instr.op].name << " " << instr.rA << " " << instr.rB << " " << instr.rC << " "
+                 << instr.imm << " " << (instr.label.empty() ? to_string(instr.offset) : instr.label);
+        }
+        cout << endl;
+    }
+
+    cout.flags(flags);
+    cout.precision(precision);
+}
+
+// Percentage of cycles spent at each occupancy, in at most 16 buckets
+static void displayHistogram(const vector<long long> &cycles)
+{
+    long long total = 0;
+    for (long long count : cycles)
+    {
+        total += count;
+    }
+    int width = ((int)cycles.size() + 15) / 16;
+    for (int low = 0; low < (int)cycles.size(); low += width)
+    {
+        int high = min(low + width, (int)cycles.size()) - 1;
+        long long count = 0;
+        for (int n = low; n <= high; ++n)
+        {
+            count += cycles[n];
+        }
+        cout << (low > 0 ? ", " : " ") << low;
+        if (high > low)
+        {
+            cout << "-" << high;
+        }
+        cout << ": " << (total > 0 ? (double)count / total * 100 : 0.0) << "%";
+    }
+    cout << endl;
+}
+
+// CPI stack from the commit slots, the issue slot breakdown, and occupancy histograms
+void Simulator::displayAccounting() const
+{
+    long long issueTotal = 0;
+    long long commitTotal = 0;
+    for (int k = 0; k < SLOT_CLASS_COUNT; ++k)
+    {
+        issueTotal += accounting.issueSlots[k];
+        commitTotal += accounting.commitSlots[k];
+    }
+    if (issueTotal == 0 || commitTotal == 0)
+    {
+        return;
+    }
+
+    // Each commit slot is 1/commitWidth of a cycle, so the stack adds up to the overall CPI
+    double scale = instructionsCompleted > 0 ? 1.0 / hardware.commitWidth / instructionsCompleted : 0.0;
+    cout << "\nCPI Stack: " << (instructionsCompleted > 0 ? (double)totalCycles / instructionsCompleted : 0.0)
+         << " cycles per instruction" << endl;
+    for (int k = 0; k < SLOT_CLASS_COUNT; ++k)
+    {
+        if (accounting.issueSlots[k] == 0 && accounting.commitSlots[k] == 0)
+        {
+            continue;
+        }
+        cout << "  " << slotClassNames[k] << ": " << accounting.commitSlots[k] * scale << " CPI ("
+             << (double)accounting.commitSlots[k] / commitTotal * 100 << "% of commit slots, "
+             << (double)accounting.issueSlots[k] / issueTotal * 100 << "% of issue slots)" << endl;
+    }
+    if (accounting.issueSlots[SLOT_STATION_FULL] > 0)
+    {
+        cout << "Station Full Issue Slots:";
+        for (int c = 0, n = 0; c < RS_CLASS_COUNT; ++c)
+        {
+            if (accounting.stationFullSlots[c] > 0)
+            {
+                cout << (n++ > 0 ? ", " : " ") << rsClassTable[c].name << " "
+                     << (double)accounting.stationFullSlots[c] / issueTotal * 100 << "%";
+            }
+        }
+        cout << endl;
+    }
+
+    cout << "ROB Occupancy (entries: % of cycles):";
+    displayHistogram(accounting.robOccupancy);
+    cout << "Station Occupancy (busy: % of cycles):" << endl;
+    for (int c = 0; c < RS_CLASS_COUNT; ++c)
+    {
+        cout << "  " << rsClassTable[c].name << ":";
+        displayHistogram(accounting.stationOccupancy[c]);
+    }
+}
+
+int Simulator::step(int n)
+{
+    long long start = totalCycles;
+    long long lastCycle = min(start + n, maxCycles);
+    while (!finished() && totalCycles < lastCycle)
+    {
+        advance(lastCycle);
+    }
+    return (int)(totalCycles - start);
+}
+
+void Simulator::runUntil(const function<bool(const Simulator &)> &predicate)
+{
+    while (!finished())
+    {
+        advance(maxCycles);
+        if (predicate(*this))
+        {
+            break;
+        }
+    }
+}
+
+void Simulator::run()
+{
+    while (!finished())
+    {
+        advance(maxCycles);
+    }
+
+    if (allInstructionsCompleted())
+    {
+        LOG(LOG_SUMMARY, "All instructions completed at cycle: " << totalCycles << endl);
+    }
+    else
+    {
+        LOG(LOG_SUMMARY, "Cycle limit reached at cycle: " << totalCycles << endl);
+    }
+}
+
+long long Simulator::fastForward(long long n)
+{
+    if (trace != nullptr)
+    {
+        return 0; // A trace carries no register or memory values to run on
+    }
+
+    // Committed state is architectural, so everything in flight is simply executed again
+    if (!reorderBuffer.empty())
+    {
+        const ROBEntry &oldest = reorderBuffer[reorderBuffer.head];
+        pc = oldest.pc;
+        predictor->restore(oldest.history);
+        ras.restore(oldest.ras);
+
+        for (int k = reorderBuffer.head, n = 0; n < reorderBuffer.count; k = reorderBuffer.next(k), ++n)
+        {
+            tracePipeline(PIPE_SQUASH, reorderBuffer[k]);
+        }
+        reorderBuffer.resize(reorderBuffer.size());
+        fill(registerStatus.begin(), registerStatus.end(), -1);
+        reservationStations.releaseAll();
+        loadStoreQueue.clear();
+        redirectPending = false;
+    }
+
+    long long count = 0;
+    for (; count < n && pc >= 0 && pc < (int)instructions.size(); ++count)
+    {
+        const Instruction &instr = instructions[pc];
+        Outcome outcome = executeInstruction(instr, pc, registers, memory);
+
+        // Functional warming, so the next detailed stretch does not start with cold predictors
+        switch (opTable[instr.op].semantics)
+        {
+        case SEM_BEQ:
+            predictor->update(pc, predictor->history(), outcome.taken);
+            predictor->speculate(outcome.taken);
+            break;
+        case SEM_CALL:
+            if (ras.enabled())
+            {
+                ras.push(pc + 1);
+            }
+            break;
+        case SEM_RET:
+            ras.pop();
+            break;
+        default:
+            break;
+        }
+        if (outcome.next != pc + 1)
+        {
+            btb.update(pc, outcome.next);
+        }
+        pc = outcome.next;
+    }
+
+    fastForwarded += count;
+    LOG(LOG_EVENT, "Fast-forwarded " << count << " instructions to PC " << pc << endl);
+    return count;
+}
+
+bool Simulator::finished() const
+{
+    return allInstructionsCompleted() || totalCycles >= maxCycles;
+}
+
+void Simulator::advance(long long lastCycle)
+{
+    if (detailedStats)
+    {
+        cycle<true>(lastCycle);
+    }
+    else
+    {
+        cycle<false>(lastCycle);
+    }
+}
+
+// Simulates one cycle; an idle stretch after it is skipped, but never past lastCycle.
+// Detailed also keeps the cycle accounting and per-PC profile, which nothing else reads.
+template <bool Detailed>
+void Simulator::cycle(long long lastCycle)
+{
+    totalCycles++;
+    activity = false;
+    LOG(LOG_CYCLE, "Cycle: " << totalCycles << ", PC: " << pc << endl);
+
+    // Commit and execute see the previous cycle's state; write only broadcasts results
+    // finished in an earlier cycle, so woken stations start executing next cycle
+    int committed = commit<Detailed>(reservationStations, reorderBuffer);
+    execute(reservationStations, reorderBuffer);
+    write<Detailed>(reservationStations, reorderBuffer);
+
+    // Issue in program order until the width is used up, an instruction stalls or fetch is redirected
+    int inFlight = reorderBuffer.count;
+    for (int n = 0; n < hardware.issueWidth; ++n)
+    {
+        bool more = trace != nullptr ? issueFromTrace() : issueFromProgram();
+        if (!more)
+        {
+            break;
+        }
+    }
+    if (Detailed)
+    {
+        accountCycles(reorderBuffer.count - inFlight, committed, 1);
+    }
+
+    if (LOG_CYCLE <= TOMASULO_MAX_LOG_LEVEL && logLevel >= LOG_CYCLE)
+    {
+        dumpState(reservationStations, reorderBuffer);
+    }
+
+    // Events up to this cycle have been handled; dropping them keeps the queue as small as the
+    // set of pending completions even when busy cycles never reach skipToNextEvent
+    while (!completionEvents.empty() && completionEvents.top().cycle <= totalCycles)
+    {
+        completionEvents.pop();
+    }
+
+    // A cycle with no progress means issue is blocked and every busy station is
+    // counting down, so nothing changes until the next station finishes
+    if (eventDriven && !activity && !allInstructionsCompleted())
+    {
+        skipToNextEvent<Detailed>(reservationStations, lastCycle);
+    }
+}
+
+// Issues the instruction at pc and moves fetch along the predicted path. Returns
+// whether issue can continue this cycle: false on a stall or a predicted-taken transfer
+bool Simulator::issueFromProgram()
+{
+    if (pc < 0 || pc >= (int)instructions.size())
+    {
+        issueStall = SLOT_FRONT_END;
+        return false;
+    }
+
+    int robIndex = issue(instructions[pc], reservationStations, reorderBuffer);
+    if (robIndex == -1)
+    {
+        return false;
+    }
+    activity = true;
+
+    int next = reorderBuffer[robIndex].predictedNext;
+    bool sequential = next == pc + 1;
+    pc = next; // Move to the next instruction on the predicted path
+    issueStall = SLOT_FRONT_END; // Charged only if a taken transfer ends the group
+    return sequential;
+}
+
+// Trace-driven fetch. The trace holds only the committed path, so after a misprediction
+// issue waits for it to commit rather than fetching a wrong path to flush
+bool Simulator::issueFromTrace()
+{
+    const TraceRecord *record = trace->peek();
+    if (redirectPending || record == nullptr)
+    {
+        issueStall = redirectPending ? SLOT_BRANCH_FLUSH : SLOT_FRONT_END;
+        return false;
+    }
+
+    // Decoded aside first: when issue stalls on a full ROB, the tail slot still
+    // belongs to the oldest in-flight instruction
+    Instruction instr;
+    if (!decodeTraceRecord(*record, instr))
+    {
+        cerr << "Error: Skipping malformed trace record " << trace->consumed() << endl;
+        trace->pop();
+        issueStall = SLOT_FRONT_END;
+        return false;
+    }
+
+    pc = record->pc; // CALL takes its return address from pc
+    int robIndex = issue(instr, reservationStations, reorderBuffer);
+    if (robIndex == -1)
+    {
+        return false;
+    }
+    instructions[robIndex] = instr; // The slot of the ROB entry it took
+    trace->pop();
+    activity = true;
+
+    int actualNext = pc + 1;
+    switch (opTable[instr.op].shape)
+    {
+    case SHAPE_BRANCH:
+        actualNext = instr.taken ? instr.target : pc + 1;
+        break;
+    case SHAPE_CALL:
+    case SHAPE_RET:
+        actualNext = instr.target;
+        break;
+    default:
+        break;
+    }
+
+    int predictedNext = reorderBuffer[robIndex].predictedNext;
+    redirectPending = predictedNext != actualNext;
+    issueStall = redirectPending ? SLOT_BRANCH_FLUSH : SLOT_FRONT_END;
+    return predictedNext == pc + 1 && !redirectPending;
+}
+
+// Next fetch address after instr: the return address stack for a RET, the BTB target for
+// a CALL, an unpredicted RET or a BEQ predicted taken, otherwise the next instruction
+int Simulator::predictNext(const Instruction &instr, ROBEntry &entry)
+{
+    // Every entry is checkpointed, so fastForward can rewind to whichever one is oldest
+    entry.history = predictor->history();
+    entry.ras = ras.checkpoint();
+
+    OperandShape shape = opTable[instr.op].shape;
+    if (shape != SHAPE_BRANCH && shape != SHAPE_CALL && shape != SHAPE_RET)
+    {
+        return entry.pc + 1;
+    }
+
+    if (shape == SHAPE_CALL && ras.enabled() && !ras.push(entry.pc + 1))
+    {
+        prediction.rasOverflows++;
+    }
+    if (shape == SHAPE_RET && ras.enabled())
+    {
+        int target = ras.pop();
+        if (target != -1)
+        {
+            return target;
+        }
+        prediction.rasUnderflows++;
+    }
+
+    if (shape == SHAPE_BRANCH)
+    {
+        entry.predictedTaken = predictor->predict(entry.pc, instr.target);
+        predictor->speculate(entry.predictedTaken);
+        if (!entry.predictedTaken)
+        {
+            return entry.pc + 1;
+        }
+    }
+
+    // Fetch can only follow a taken transfer once the BTB has seen its target
+    prediction.btbLookups++;
+    int target;
+    if (!btb.lookup(entry.pc, target))
+    {
+        return entry.pc + 1;
+    }
+    prediction.btbHits++;
+    return target;
+}
+
+// Resolves a source register to a value or to the ROB tag that will produce it
+void Simulator::readOperand(int reg, int &value, int &tag, const ReorderBuffer &rob)
+{
+    int producer = registerStatus[reg];
+    if (producer == -1)
+    {
+        value = registers[reg];
+        tag = -1;
+    }
+    else if (rob[producer].ready)
+    {
+        value = rob[producer].value; // Written but not yet committed
+        tag = -1;
+    }
+    else
+    {
+        value = 0;
+        tag = producer; // Wait for the result on the CDB
+    }
+}
+
+// Returns the ROB entry the instruction took, or -1 if it stalled
+int Simulator::issue(const Instruction &instr, ReservationStations &reservationStations, ReorderBuffer &reorderBuffer)
+{
+    const OpInfo &info = opTable[instr.op];
+
+    // Step 1: Check for a free ROB entry
+    if (reorderBuffer.full())
+    {
+        LOG(LOG_EVENT, "ROB full, cannot issue instruction: " << info.name << endl);
+        issueStall = SLOT_ROB_FULL;
+        return -1;
+    }
+
+    // Memory operations also need a load/store queue entry
+    bool memoryOp = info.shape == SHAPE_LOAD || info.shape == SHAPE_STORE;
+    if (memoryOp && loadStoreQueue.full())
+    {
+        LOG(LOG_EVENT, "Load/store queue full, cannot issue instruction: " << info.name << endl);
+        issueStall = SLOT_MEMORY;
+        return -1;
+    }
+
+    // Step 2: Take a free station of the instruction's functional unit class
+    ReservationStations &rs = reservationStations;
+    int i = rs.allocate(info.rsClass);
+    if (i == -1)
+    {
+        // If no reservation station is available, stall this instruction
+        LOG(LOG_EVENT, "No available " << rsClassTable[info.rsClass].name << " reservation station for instruction: " << info.name << endl);
+        issueStall = SLOT_STATION_FULL;
+        stalledClass = info.rsClass;
+        return -1;
+    }
+
+    int robIndex = reorderBuffer.allocate();
+
+    rs.op[i] = instr.op;
+    rs.robIndex[i] = robIndex;                    // Link to ROB entry
+    rs.cyclesLeft[i] = operationCycles[instr.op]; // Assign remaining cycles
+    rs.completionCycle[i] = -1;
+    rs.Qj[i] = -1;
+    rs.Qk[i] = -1;
+
+    // Step 3: Handle operands and dependencies
+    switch (info.shape)
+    {
+    case SHAPE_LOAD:
+        readOperand(instr.rB, rs.Vj[i], rs.Qj[i], reorderBuffer); // Base register
+        rs.address[i] = instr.offset;                             // Base is added in execute
+        break;
+    case SHAPE_STORE:
+        readOperand(instr.rB, rs.Vj[i], rs.Qj[i], reorderBuffer); // Base register
+        readOperand(instr.rA, rs.Vk[i], rs.Qk[i], reorderBuffer); // Value stored to memory
+        rs.address[i] = instr.offset;
+        break;
+    case SHAPE_BRANCH:
+        readOperand(instr.rA, rs.Vj[i], rs.Qj[i], reorderBuffer);
+        readOperand(instr.rB, rs.Vk[i], rs.Qk[i], reorderBuffer);
+        rs.address[i] = instr.target;
+        break;
+    case SHAPE_CALL:
+        rs.Vj[i] = pc + 1; // Return address
+        break;
+    case SHAPE_RET:
+        readOperand(1, rs.Vj[i], rs.Qj[i], reorderBuffer); // Return to address stored in R1
+        break;
+    case SHAPE_RRI:
+        readOperand(instr.rB, rs.Vj[i], rs.Qj[i], reorderBuffer);
+        rs.Vk[i] = instr.imm;
+        break;
+    case SHAPE_RRR:
+        readOperand(instr.rB, rs.Vj[i], rs.Qj[i], reorderBuffer);
+        readOperand(instr.rC, rs.Vk[i], rs.Qk[i], reorderBuffer);
+        break;
+    }
+
+    // Step 4: Initialize ROB entry
+    ROBEntry &entry = reorderBuffer[robIndex];
+    entry.instructionID = trace != nullptr ? robIndex : pc;
+    entry.op = instr.op;
+    entry.destination = destinationRegister(instr);
+    entry.state = ROB_ISSUE;
+    entry.ready = false;
+    entry.pc = pc;
+    entry.progress.issuedCycle = totalCycles;
+    entry.sourceTags[0] = rs.Qj[i];
+    entry.sourceTags[1] = rs.Qk[i];
+    entry.sequence = sequence++;
+    entry.predictedNext = predictNext(instr, entry);
+    tracePipeline(PIPE_ISSUE, entry);
+
+    if (memoryOp)
+    {
+        entry.lsqIndex = loadStoreQueue.allocate();
+        LSQEntry &slot = loadStoreQueue[entry.lsqIndex];
+        slot.robIndex = robIndex;
+        slot.station = i;
+        slot.store = info.shape == SHAPE_STORE;
+    }
+
+    // Rename the destination after reading sources so "ADD 1 1 1" sees the old R1
+    if (entry.destination != -1)
+    {
+        registerStatus[entry.destination] = robIndex;
+    }
+
+    // Set speculative flag for branch-related instructions
+    entry.speculative = (info.shape == SHAPE_BRANCH || info.shape == SHAPE_CALL || info.shape == SHAPE_RET);
+
+    LOG(LOG_EVENT, "Issued instruction: " << info.name << " to ROB entry " << robIndex << endl);
+    return robIndex;
+}
+
+void Simulator::execute(ReservationStations &rs, ReorderBuffer &rob)
+{
+    computeAddresses(rs);
+
+    // Count down stations already dispatched to their functional unit
+    for (auto &pool : rs.pools)
+    {
+        for (uint64_t running = pool.executing; running != 0; running &= running - 1)
+        {
+            int i = pool.base + lowestSetBit(running);
+            if (rs.isResultReady(i))
+            {
+                continue; // Waiting for the write stage
+            }
+
+            if (--rs.cyclesLeft[i] <= 0)
+            {
+                finishExecution(rs, rob, i);
+            }
+        }
+    }
+
+    // Select: each free functional unit accepts the oldest station of its class whose operands are ready
+    for (int c = 0; c < RS_CLASS_COUNT; ++c)
+    {
+        const StationPool &pool = rs.pools[c];
+        uint64_t ready = 0;
+        for (uint64_t waiting = pool.busyMask() & ~pool.executing; waiting != 0; waiting &= waiting - 1)
+        {
+            int s = lowestSetBit(waiting);
+            int i = pool.base + s;
+            if (rs.Qj[i] == -1 && rs.Qk[i] == -1 && (opTable[rs.op[i]].semantics != SEM_LOAD || resolveLoad(rs, rob, i)))
+            {
+                ready |= 1ULL << s;
+            }
+        }
+
+        for (long long &unitFree : unitFreeCycle[c])
+        {
+            if (ready == 0)
+            {
+                break;
+            }
+            if (unitFree > totalCycles)
+            {
+                continue; // Still inside the initiation interval of its last operation
+            }
+
+            int s = pool.selectOldest(ready);
+            ready &= ~(1ULL << s);
+            dispatch(rs, rob, pool.base + s, unitFree);
+        }
+    }
+}
+
+// Starts station i on a functional unit; unitFree is that unit's next free cycle
+void Simulator::dispatch(ReservationStations &rs, ReorderBuffer &rob, int i, long long &unitFree)
+{
+    StationPool &pool = rs.pools[rs.stationClass[i]];
+    pool.executing |= 1ULL << (i - pool.base);
+
+    ROBEntry &entry = rob[rs.robIndex[i]];
+    entry.state = ROB_EXECUTE;
+    entry.progress.startExecCycle = totalCycles;
+    tracePipeline(PIPE_START_EXEC, entry);
+
+    if (entry.lsqIndex != -1 && !loadStoreQueue[entry.lsqIndex].store)
+    {
+        const LSQEntry &slot = loadStoreQueue[entry.lsqIndex];
+        if (slot.forwarded)
+        {
+            memoryCounters.forwardedLoads++;
+            rs.cyclesLeft[i] = 1; // Read from the queue instead of memory
+        }
+        else if (slot.bypassed)
+        {
+            memoryCounters.bypassingLoads++;
+        }
+    }
+
+    int latency = max(rs.cyclesLeft[i], 1);
+    rs.completionCycle[i] = totalCycles + latency - 1;
+    completionEvents.push({rs.completionCycle[i], i});
+
+    // A pipelined unit takes a new operation every interval; an unpipelined one waits out the latency
+    int interval = hardware.intervals[rs.stationClass[i]];
+    unitFree = totalCycles + (interval > 0 ? interval : latency);
+    if (unitFree > totalCycles + 1)
+    {
+        completionEvents.push({unitFree, -1}); // Waiting stations may dispatch then
+    }
+    activity = true;
+
+    LOG(LOG_EVENT, "Dispatched " << opTable[rs.op[i]].name << " from ROB entry " << rs.robIndex[i] << endl);
+
+    // The dispatch cycle is the first cycle of execution
+    if (--rs.cyclesLeft[i] <= 0)
+    {
+        finishExecution(rs, rob, i);
+    }
+}
+
+// Address generation: effective addresses and store data are captured as soon as the base
+// and value operands arrive, ahead of the memory access itself
+void Simulator::computeAddresses(const ReservationStations &rs)
+{
+    for (int k = loadStoreQueue.head, n = 0; n < loadStoreQueue.count; k = loadStoreQueue.next(k), ++n)
+    {
+        LSQEntry &slot = loadStoreQueue[k];
+        int s = slot.station;
+        if (!slot.addressKnown && rs.Qj[s] == ReservationStations::NO_TAG)
+        {
+            slot.address = trace != nullptr ? rs.address[s] : rs.Vj[s] + rs.address[s]; // Traces record the address itself
+            slot.addressKnown = true;
+        }
+        if (slot.store && !slot.dataKnown && rs.Qk[s] == ReservationStations::NO_TAG)
+        {
+            slot.data = rs.Vk[s];
+            slot.dataKnown = true;
+        }
+    }
+}
+
+// Memory disambiguation for the load in station i, checked against older stores youngest
+// first. The load waits while an older store has no address yet or matches without its
+// data; otherwise it goes to memory or takes the value of the youngest matching store.
+bool Simulator::resolveLoad(const ReservationStations &rs, const ReorderBuffer &rob, int i)
+{
+    int index = rob[rs.robIndex[i]].lsqIndex;
+    LSQEntry &load = loadStoreQueue[index];
+    if (!load.addressKnown)
+    {
+        return false;
+    }
+
+    load.forwarded = load.bypassed = false;
+    for (int k = index; k != loadStoreQueue.head;)
+    {
+        k = loadStoreQueue.prev(k);
+        const LSQEntry &older = loadStoreQueue[k];
+        if (!older.store)
+        {
+            continue;
+        }
+        if (!older.addressKnown)
+        {
+            return false;
+        }
+        if (older.address == load.address)
+        {
+            if (!older.dataKnown)
+            {
+                return false;
+            }
+            load.forwarded = true;
+            load.data = older.data;
+            return true;
+        }
+        load.bypassed = true;
+    }
+    return true;
+}
+
+// Performs the operation of station i once its latency has elapsed
+void Simulator::finishExecution(ReservationStations &rs, ReorderBuffer &rob, int i)
+{
+    ROBEntry &entry = rob[rs.robIndex[i]];
+    const Instruction &instr = instructions[entry.instructionID];
+    int &result = rs.result[i];
+    switch (opTable[rs.op[i]].semantics)
+    {
+    case SEM_ADD:
+        result = (int)((unsigned)rs.Vj[i] + (unsigned)rs.Vk[i]); // Vk is the immediate value for ADDI; wraps like hardware
+        break;
+    case SEM_NAND:
+        result = ~(rs.Vj[i] & rs.Vk[i]);
+        break;
+    case SEM_MUL:
+        result = (int)((unsigned)rs.Vj[i] * (unsigned)rs.Vk[i]);
+        break;
+    case SEM_LOAD:
+    {
+        const LSQEntry &slot = loadStoreQueue[entry.lsqIndex];
+        rs.address[i] = slot.address;
+        result = slot.forwarded ? slot.data : memory.read(slot.address);
+        break;
+    }
+    case SEM_STORE:
+        rs.address[i] = loadStoreQueue[entry.lsqIndex].address;
+        result = rs.Vk[i]; // Memory is written when the store commits
+        break;
+    case SEM_BEQ:
+        result = trace != nullptr ? instr.taken : (rs.Vj[i] == rs.Vk[i]) ? 1 : 0; // 1 = branch taken
+        break;
+    case SEM_CALL:
+        result = rs.Vj[i]; // Return address
+        break;
+    case SEM_RET:
+        result = trace != nullptr ? instr.target : rs.Vj[i]; // Return target
+        break;
+    }
+
+    // Mark the result as ready
+    ReservationStations::set(rs.resultReady, i);
+    activity = true;
+    entry.progress.endExecCycle = totalCycles;
+    tracePipeline(PIPE_END_EXEC, entry);
+}
+
+// Retires up to commitWidth entries in order from the ROB head
+// Returns the number of instructions retired
+template <bool Detailed>
+int Simulator::commit(ReservationStations &reservationStations, ReorderBuffer &rob)
+{
+    for (int n = 0; n < hardware.commitWidth; ++n)
+    {
+        if (!commitHead<Detailed>(reservationStations, rob))
+        {
+            if (Detailed)
+            {
+                commitStall = classifyCommitStall(reservationStations, rob);
+            }
+            return n;
+        }
+    }
+    return hardware.commitWidth;
+}
+
+// Why the head of the ROB cannot commit this cycle. The head's own producers have already
+// committed, so a head that issued waiting for operands is charged to that dependence chain.
+SlotClass Simulator::classifyCommitStall(const ReservationStations &rs, const ReorderBuffer &rob) const
+{
+    if (rob.empty())
+    {
+        // Only a flush empties the ROB while there is still program to fetch
+        return fetchDone() || instructionsCompleted == 0 ? SLOT_FRONT_END : SLOT_BRANCH_FLUSH;
+    }
+
+    const ROBEntry &head = rob[rob.head];
+    if (head.state == ROB_EXECUTE)
+    {
+        for (int i = 0; i < rs.count; ++i)
+        {
+            // A result finished last cycle is being written now; an older one lost arbitration
+            if (rs.isBusy(i) && rs.robIndex[i] == rob.head && rs.isResultReady(i) &&
+                rs.completionCycle[i] < totalCycles - 1)
+            {
+                return SLOT_CDB;
+            }
+        }
+    }
+    if (head.lsqIndex != -1)
+    {
+        return SLOT_MEMORY;
+    }
+    return head.waitedForOperands() ? SLOT_OPERAND_WAIT : SLOT_EXECUTION;
+}
+
+// Retires the head entry if its result has been written; false if it cannot commit yet
+template <bool Detailed>
+bool Simulator::commitHead(ReservationStations &reservationStations, ReorderBuffer &rob)
+{
+    if (rob.empty())
+    {
+        return false;
+    }
+
+    // Retire in order: only the head entry can commit
+    ROBEntry &entry = rob[rob.head];
+
+    if (!entry.ready || entry.state != ROB_WRITE)
+    {
+        return false;
+    }
+
+    Instruction &instr = instructions[entry.instructionID];
+    entry.progress.commitCycle = totalCycles;
+    instr.progress = entry.progress;
+
+    // Commit result to destination register (not for STORE/BEQ/RET)
+    if (entry.destination != -1)
+    {
+        registers[entry.destination] = entry.value;
+        if (registerStatus[entry.destination] == rob.head)
+        {
+            registerStatus[entry.destination] = -1; // No younger writer, register file is current
+        }
+        LOG(LOG_EVENT, "Committed result to R" << entry.destination << ": " << entry.value << endl);
+    }
+
+    // Memory operations leave the load/store queue in order; only now does a store reach memory
+    if (entry.lsqIndex != -1)
+    {
+        const LSQEntry &slot = loadStoreQueue[entry.lsqIndex];
+        if (slot.store)
+        {
+            memory.write(slot.address, slot.data);
+            LOG(LOG_EVENT, "Committed store to Memory[" << slot.address << "]: " << slot.data << endl);
+        }
+        loadStoreQueue.retire();
+    }
+
+    // Resolve control flow against the path fetch followed; -1 is a real target (it ends the program)
+    bool transfer = true;
+    int actualNext = entry.pc + 1;
+    switch (opTable[entry.op].shape)
+    {
+    case SHAPE_BRANCH:
+    {
+        bool taken = entry.value == 1;
+        totalBranches++;
+        if (taken != entry.predictedTaken)
+        {
+            prediction.directionMisses++;
+        }
+        predictor->update(entry.pc, entry.history, taken);
+
+        actualNext = taken ? instr.target : entry.pc + 1;
+        if (actualNext != entry.predictedNext)
+        {
+            branchMispredictions++;
+        }
+        break;
+    }
+    case SHAPE_CALL:
+        actualNext = instr.target;
+        break;
+    case SHAPE_RET:
+        actualNext = entry.value;
+        break;
+    default:
+        transfer = false;
+        break;
+    }
+
+    instructionsCompleted++;
+    activity = true;
+    if (Detailed)
+    {
+        profileCommit(entry);
+    }
+    tracePipeline(PIPE_COMMIT, entry);
+
+    if (transfer)
+    {
+        if (actualNext != entry.pc + 1)
+        {
+            btb.update(entry.pc, actualNext); // Only taken transfers need a target
+        }
+        if (actualNext != entry.predictedNext)
+        {
+            if (opTable[entry.op].shape != SHAPE_BRANCH)
+            {
+                prediction.targetMisses++;
+            }
+            prediction.flushes++;
+            prediction.flushCycles += totalCycles - entry.progress.issuedCycle;
+
+            // Drop the outcomes predicted on the wrong path
+            bool isBranch = opTable[entry.op].shape == SHAPE_BRANCH;
+            predictor->restore(isBranch ? (entry.history << 1) | (entry.value == 1 ? 1 : 0) : entry.history);
+            if (ras.enabled())
+            {
+                ras.restore(entry.ras);
+                if (opTable[entry.op].shape == SHAPE_CALL)
+                {
+                    ras.push(entry.pc + 1);
+                }
+                else if (opTable[entry.op].shape == SHAPE_RET)
+                {
+                    ras.pop();
+                }
+            }
+            handleBranch<Detailed>(reservationStations, rob, actualNext);
+        }
+    }
+    rob.retire();
+    return true;
+}
+
+template <bool Detailed>
+void Simulator::write(ReservationStations &rs, ReorderBuffer &reorderBuffer)
+{
+    cdbRequests.clear();
+    for (int w = 0; w < rs.resultReady.size(); ++w)
+    {
+        for (uint64_t finished = rs.resultReady[w]; finished != 0; finished &= finished - 1)
+        {
+            int i = w * 64 + lowestSetBit(finished);
+            if (rs.completionCycle[i] < totalCycles) // Results finished this cycle are written next cycle
+            {
+                cdbRequests.push_back(i);
+            }
+        }
+    }
+
+    // With a limited CDB the arbitration policy picks the winners; the rest retry next cycle
+    int buses = hardware.cdbWidth > 0 ? hardware.cdbWidth : (int)cdbRequests.size();
+    if ((int)cdbRequests.size() > buses)
+    {
+        cdbCounters.contentionCycles++;
+        cdbCounters.deferredResults += (long long)cdbRequests.size() - buses;
+
+        auto age = [&](int i)
+        { return (rs.robIndex[i] - reorderBuffer.head + reorderBuffer.size()) % reorderBuffer.size(); };
+        auto wins = [&](int a, int b)
+        {
+            if (hardware.cdbArbitration == CDB_UNIT_PRIORITY && rs.stationClass[a] != rs.stationClass[b])
+            {
+                return rs.stationClass[a] < rs.stationClass[b];
+            }
+            return age(a) < age(b);
+        };
+        nth_element(cdbRequests.begin(), cdbRequests.begin() + buses, cdbRequests.end(), wins);
+        cdbRequests.resize(buses);
+    }
+    if (hardware.cdbWidth > 0 && (int)cdbRequests.size() == hardware.cdbWidth)
+    {
+        cdbCounters.saturatedCycles++;
+    }
+    cdbCounters.broadcasts += cdbRequests.size();
+
+    for (int i : cdbRequests)
+    {
+        // Write result to ROB
+        int robIndex = rs.robIndex[i];
+        ROBEntry &entry = reorderBuffer[robIndex];
+        entry.value = rs.result[i];
+        entry.ready = true;
+        entry.state = ROB_WRITE;
+        entry.progress.writeCycle = totalCycles;
+        tracePipeline(PIPE_WRITE, entry);
+
+        // Broadcast result on the CDB; woken stations record who they waited for, for the profile
+        const vector<uint64_t> &woken = rs.broadcast(robIndex, rs.result[i]);
+        if (Detailed)
+        {
+            for (int w = 0; w < (int)woken.size(); ++w)
+            {
+                for (uint64_t matched = woken[w] & rs.busy[w]; matched != 0; matched &= matched - 1)
+                {
+                    ROBEntry &consumer = reorderBuffer[rs.robIndex[w * 64 + lowestSetBit(matched)]];
+                    consumer.operandsReadyCycle = totalCycles;
+                    consumer.producerPc = entry.pc;
+                }
+            }
+        }
+
+        // Free reservation station
+        rs.release(i);
+        activity = true;
+
+        LOG(LOG_EVENT, "Wrote result for instruction in ROB entry " << robIndex << endl);
+    }
+}
+
+// Per-cycle debug dump of every busy station and in-flight ROB entry
+void Simulator::dumpState(const ReservationStations &rs, const ReorderBuffer &rob) const
+{
+    for (int i = 0; i < rs.count; ++i)
+    {
+        if (rs.isBusy(i))
+        {
+            cout << "RS " << i << " op: " << opTable[rs.op[i]].name << ", ROB entry: " << rs.robIndex[i]
+                 << ", Qj: " << rs.Qj[i] << ", Qk: " << rs.Qk[i] << ", cyclesLeft: " << rs.cyclesLeft[i]
+                 << ", resultReady: " << rs.isResultReady(i) << endl;
+        }
+    }
+    for (int i = rob.head, n = 0; n < rob.count; i = rob.next(i), ++n)
+    {
+        const ROBEntry &entry = rob[i];
+        cout << "ROB entry " << i << ": " << opTable[entry.op].name << ", state = " << robStateNames[entry.state]
+             << ", destination = " << entry.destination << ", value = " << entry.value << ", ready = " << entry.ready << endl;
+    }
+}
+
+bool Simulator::fetchDone() const
+{
+    return trace != nullptr ? trace->exhausted() : pc < 0 || pc >= (int)instructions.size();
+}
+
+bool Simulator::allInstructionsCompleted() const
+{
+    // Reservation stations are freed at write, before the ROB entry can commit
+    return fetchDone() && reorderBuffer.empty();
+}
+
+// Charges cycles identical cycles: issued and committed slots were used, the rest of each width
+// goes to the last stall reason. Occupancy is sampled at the end of the cycle.
+void Simulator::accountCycles(int issued, int committed, long long cycles)
+{
+    accounting.issueSlots[SLOT_USEFUL] += issued * cycles;
+    accounting.issueSlots[issueStall] += (hardware.issueWidth - issued) * cycles;
+    if (issueStall == SLOT_STATION_FULL)
+    {
+        accounting.stationFullSlots[stalledClass] += (hardware.issueWidth - issued) * cycles;
+    }
+    accounting.commitSlots[SLOT_USEFUL] += committed * cycles;
+    accounting.commitSlots[commitStall] += (hardware.commitWidth - committed) * cycles;
+
+    accounting.robOccupancy[reorderBuffer.count] += cycles;
+    for (int c = 0; c < RS_CLASS_COUNT; ++c)
+    {
+        accounting.stationOccupancy[c][countSetBits(reservationStations.pools[c].busyMask())] += cycles;
+    }
+}
+
+template <bool Detailed>
+void Simulator::handleBranch(ReservationStations &reservationStations, ReorderBuffer &rob, int target)
+{
+    LOG(LOG_EVENT, "Control transfer at ROB entry " << rob.head << ". Flushing younger instructions..." << endl);
+
+    // Everything behind the head is on the wrong path, so its issue slots were wasted
+    if (Detailed)
+    {
+        accounting.issueSlots[SLOT_USEFUL] -= rob.count - 1;
+        accounting.issueSlots[SLOT_BRANCH_FLUSH] += rob.count - 1;
+    }
+    for (int k = rob.next(rob.head), n = 1; n < rob.count; k = rob.next(k), ++n)
+    {
+        tracePipeline(PIPE_SQUASH, rob[k]);
+    }
+    rob.flushAfter(rob.head);
+    fill(registerStatus.begin(), registerStatus.end(), -1);
+
+    reservationStations.releaseAll(); // The head's own station was freed at write
+    loadStoreQueue.clear();           // The head is a control transfer, so every entry is younger
+
+    // Update PC to the correct branch target
+    pc = target;
+    redirectPending = false;
+
+    LOG(LOG_EVENT, "Rollback complete. Fetch resumed at " << pc << "." << endl);
+}
+
+void Simulator::tracePipeline(PipeEventKind kind, const ROBEntry &entry)
+{
+    if (pipeview == nullptr)
+    {
+        return;
+    }
+    PipeEvent event = {};
+    event.cycle = totalCycles;
+    event.sequence = entry.sequence;
+    event.pc = entry.pc;
+    event.kind = kind;
+    event.op = (uint8_t)entry.op;
+    pipeview->record(event);
+}
+
+template <bool Detailed>
+void Simulator::skipToNextEvent(ReservationStations &reservationStations, long long lastCycle)
+{
+    // Drop events for stations that were flushed or have already finished
+    while (!completionEvents.empty())
+    {
+        const CompletionEvent &event = completionEvents.top();
+        int i = event.station;
+        if (event.cycle > totalCycles &&
+            (i == -1 || (reservationStations.isBusy(i) && !reservationStations.isResultReady(i) &&
+                         reservationStations.completionCycle[i] == event.cycle)))
+        {
+            break;
+        }
+        completionEvents.pop();
+    }
+
+    if (completionEvents.empty())
+    {
+        return; // Nothing in flight, so stepping cannot make progress either
+    }
+
+    // Jump to the cycle just before the next completion and apply the countdown in bulk
+    long long target = min(completionEvents.top().cycle - 1, lastCycle);
+    int skipped = (int)(target - totalCycles); // Bounded by the latency of the next completion
+    if (skipped <= 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i < reservationStations.count; ++i)
+    {
+        if (reservationStations.isBusy(i) && !reservationStations.isResultReady(i) && reservationStations.completionCycle[i] != -1)
+        {
+            reservationStations.cyclesLeft[i] -= skipped;
+        }
+    }
+    if (Detailed)
+    {
+        accountCycles(0, 0, skipped); // Idle cycles stall for the same reasons as the one before
+    }
+    totalCycles = target;
+}
+
+void loadMemoryFromFile(PagedMemory &memory, const string &filename)
+{
+    ifstream memoryFile(filename);
+    if (!memoryFile)
+    {
+        cerr << "Error: Could not open memory file!" << endl;
+        return;
+    }
+
+    int address, value;
+    while (memoryFile >> address >> value)
+    {
+        memory.write(address, value); // Load address-value pairs into memory
+    }
+
+    memoryFile.close();
+    LOG(LOG_SUMMARY, "Memory loaded successfully from file: " << filename << endl);
+}
+
+void loadInstructionsFromFile(vector<Instruction> &instructions, const string &filename)
+{
+    map<string, int> labelAddresses;
+    ifstream inputFile(filename);
+    if (!inputFile)
+    {
+        cerr << "Error: Could not open instructions file!" << endl;
+        return;
+    }
+
+    string line;
+    int address = 0;
+
+    // First pass: Store label addresses and instructions
+    while (getline(inputFile, line))
+    {
+        // Skip empty lines
+        if (line.empty())
+        {
+            continue;
+        }
+
+        // If the line ends with a colon, it's a label
+        if (line.back() == ':')
+        {
+            string label = line.substr(0, line.length() - 1); // Remove the colon
+            labelAddresses[label] = address;                  // Store label and its address
+        }
+        else
+        {
+            Instruction instr;
+            string opcode, offset;
+            stringstream ss(line);
+            ss >> opcode >> instr.rA >> instr.rB >> instr.rC >> instr.imm >> offset;
+
+            // Check for parsing errors
+            if (ss.fail())
+            {
+                cerr << "Error: Invalid instruction format in file at line: " << line << endl;
+                continue;
+            }
+
+            instr.op = decodeOpcode(opcode);
+            if (instr.op == OP_INVALID)
+            {
+                cerr << "Error: Unknown opcode " << opcode << " at line: " << line << endl;
+                continue;
+            }
+
+            // The last field is either a numeric offset or a target label
+            char *end;
+            long value = strtol(offset.c_str(), &end, 10);
+            if (*end == '\0')
+            {
+                instr.offset = (int)value;
+            }
+            else
+            {
+                instr.label = offset;
+            }
+
+            // Save the instruction and increment the address
+            instructions.push_back(instr);
+            address++; // Increment address for each instruction
+        }
+    }
+
+    // Second pass: Replace labels with their addresses
+    for (int i = 0; i < instructions.size(); ++i)
+    {
+        Instruction &instr = instructions[i];
+        if (instr.op != OP_BEQ && instr.op != OP_CALL)
+        {
+            continue;
+        }
+
+        if (instr.label.empty())
+        {
+            instr.target = i + 1 + instr.offset; // Numeric offset is PC-relative
+        }
+        else if (labelAddresses.find(instr.label) != labelAddresses.end())
+        {
+            instr.target = labelAddresses[instr.label]; // Replace label with its address
+        }
+        else
+        {
+            cerr << "Error: Undefined label " << instr.label << endl;
+        }
+
+        if (instr.op == OP_CALL)
+        {
+            instr.rA = 1; // R1 holds the return address
+        }
+    }
+
+    inputFile.close();
+    LOG(LOG_SUMMARY, "Instructions loaded and parsed successfully from file: " << filename << endl);
+}
@@ -0,0 +1,971 @@
+#ifndef TOMASULO_H
+#define TOMASULO_H
+
+#include <iostream>
+#include <utility>
+#include <vector>
+#include <array>
+#include <string>
+#include <cstdint>
+#include <queue>
+#include <functional>
+#include <algorithm>
+#include <memory>
+#include "predictor.h"
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+
+// Log levels, from least to most verbose
+enum LogLevel
+{
+    LOG_OFF,     // Nothing beyond the final metrics
+    LOG_SUMMARY, // Load and completion messages
+    LOG_EVENT,   // Issue, dispatch, write, commit, flush and stall events
+    LOG_CYCLE    // Full station and ROB dump every cycle
+};
+
+// Highest level compiled in (a LogLevel value); anything above it is removed by the compiler
+#ifndef TOMASULO_MAX_LOG_LEVEL
+#ifdef NDEBUG
+#define TOMASULO_MAX_LOG_LEVEL 1 // LOG_SUMMARY
+#else
+#define TOMASULO_MAX_LOG_LEVEL 3 // LOG_CYCLE
+#endif
+#endif
+
+extern int logLevel; // Runtime level, capped by TOMASULO_MAX_LOG_LEVEL; LOG_OFF by default
+
+// LOG(LOG_EVENT, "x = " << x << endl): the stream expression is only evaluated when enabled
+#define LOG(level, message)                                                   \
+    do                                                                        \
+    {                                                                         \
+        if ((level) <= TOMASULO_MAX_LOG_LEVEL && (level) <= logLevel)         \
+        {                                                                     \
+            std::cout << message;                                                  \
+        }                                                                     \
+    } while (0)
+
+// Opcodes are decoded once at load time; everything after that indexes opTable
+enum Opcode : uint8_t
+{
+    OP_LOAD,
+    OP_STORE,
+    OP_BEQ,
+    OP_CALL,
+    OP_RET,
+    OP_ADD,
+    OP_ADDI,
+    OP_NAND,
+    OP_MUL,
+    OP_COUNT,
+    OP_INVALID = OP_COUNT
+};
+
+// Reservation station class an opcode is issued to
+enum RSClass : uint8_t
+{
+    RS_LOAD,
+    RS_STORE,
+    RS_BEQ,
+    RS_CALLRET,
+    RS_ADD, // ADD and ADDI
+    RS_NAND,
+    RS_MUL,
+    RS_CLASS_COUNT
+};
+
+// Which instruction fields are sources and which is the destination
+enum OperandShape : uint8_t
+{
+    SHAPE_RRR,    // rA <- rB op rC
+    SHAPE_RRI,    // rA <- rB op imm
+    SHAPE_LOAD,   // rA <- memory[rB + offset]
+    SHAPE_STORE,  // memory[rB + offset] <- rA
+    SHAPE_BRANCH, // if rA == rB goto target
+    SHAPE_CALL,   // R1 <- pc + 1, goto target
+    SHAPE_RET     // goto R1
+};
+
+// What the functional unit computes
+enum Semantics : uint8_t
+{
+    SEM_ADD,
+    SEM_NAND,
+    SEM_MUL,
+    SEM_LOAD,
+    SEM_STORE,
+    SEM_BEQ,
+    SEM_CALL,
+    SEM_RET
+};
+
+struct OpInfo
+{
+    const char *name;    // Mnemonic as written in the program file
+    int latency;         // Default execution cycles
+    RSClass rsClass;     // Reservation station class
+    OperandShape shape;  // Operand layout
+    Semantics semantics; // Operation performed in execute
+};
+
+constexpr OpInfo opTable[OP_COUNT] = {
+    {"LOAD", 6, RS_LOAD, SHAPE_LOAD, SEM_LOAD},
+    {"STORE", 6, RS_STORE, SHAPE_STORE, SEM_STORE},
+    {"BEQ", 1, RS_BEQ, SHAPE_BRANCH, SEM_BEQ},
+    {"CALL", 1, RS_CALLRET, SHAPE_CALL, SEM_CALL},
+    {"RET", 1, RS_CALLRET, SHAPE_RET, SEM_RET},
+    {"ADD", 2, RS_ADD, SHAPE_RRR, SEM_ADD},
+    {"ADDI", 2, RS_ADD, SHAPE_RRI, SEM_ADD},
+    {"NAND", 1, RS_NAND, SHAPE_RRR, SEM_NAND},
+    {"MUL", 8, RS_MUL, SHAPE_RRR, SEM_MUL}};
+
+typedef std::array<int, OP_COUNT> OpTable;
+
+constexpr OpTable defaultOperationCycles()
+{
+    OpTable cycles{};
+    for (int op = 0; op < OP_COUNT; ++op)
+    {
+        cycles[op] = opTable[op].latency;
+    }
+    return cycles;
+}
+
+struct RSClassInfo
+{
+    const char *name; // Name used in prompts and reports
+    int stations;     // Default number of reservation stations
+};
+
+constexpr RSClassInfo rsClassTable[RS_CLASS_COUNT] = {
+    {"LOAD", 2},
+    {"STORE", 1},
+    {"BEQ", 1},
+    {"CALL/RET", 1},
+    {"ADD/ADDI", 4},
+    {"NAND", 2},
+    {"MUL", 1}};
+
+typedef std::array<int, RS_CLASS_COUNT> RSClassTable;
+
+constexpr RSClassTable defaultReservationStations()
+{
+    RSClassTable stations{};
+    for (int c = 0; c < RS_CLASS_COUNT; ++c)
+    {
+        stations[c] = rsClassTable[c].stations;
+    }
+    return stations;
+}
+
+constexpr RSClassTable uniformRSClassTable(int value)
+{
+    RSClassTable table{};
+    for (int c = 0; c < RS_CLASS_COUNT; ++c)
+    {
+        table[c] = value;
+    }
+    return table;
+}
+
+struct InstructionProgress
+{
+    long long issuedCycle = -1;    // Cycle when the instruction was issued
+    long long startExecCycle = -1; // Cycle when execution started
+    long long endExecCycle = -1;   // Cycle when execution ended
+    long long writeCycle = -1;     // Cycle when write-back occurred
+    long long commitCycle = -1;    // Cycle when the instruction was committed
+};
+
+struct Instruction
+{
+    Opcode op;       // Decoded opcode
+    int rA, rB, rC;  // Registers
+    int imm;         // Immediate value
+    int offset = 0;  // Offset for memory operations
+    int target = -1; // Resolved BEQ/CALL target address
+    bool taken = false;   // Recorded BEQ outcome (trace-driven mode)
+    std::string label;    // Target label as written in the program file
+    InstructionProgress progress; // Timing of the most recently committed instance
+};
+
+inline int lowestSetBit(uint64_t mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return (int)index;
+#else
+    return __builtin_ctzll(mask);
+#endif
+}
+
+inline int countSetBits(uint64_t mask)
+{
+#ifdef _MSC_VER
+    return (int)__popcnt64(mask);
+#else
+    return __builtin_popcountll(mask);
+#endif
+}
+
+// Stations of one functional unit class: a contiguous range of the station arrays
+// with bitmask free list and an age matrix for oldest-first selection
+struct StationPool
+{
+    static constexpr int MAX_STATIONS = 64; // One bit per station in each mask
+
+    int base = 0;              // Index of the first station in the pool
+    int size = 0;              // Number of stations in the pool
+    uint64_t freeMask = 0;     // Bit set = station free
+    uint64_t executing = 0;    // Bit set = station dispatched to the functional unit
+    uint64_t olderThan[MAX_STATIONS]; // olderThan[s] = busy stations issued before s
+
+    uint64_t busyMask() const { return ~freeMask & (size == 64 ? ~0ULL : (1ULL << size) - 1); }
+
+    // Takes the lowest free station and records everything already busy as older
+    int allocate()
+    {
+        int s = lowestSetBit(freeMask);
+        uint64_t bit = 1ULL << s;
+        for (uint64_t busy = busyMask(); busy != 0; busy &= busy - 1)
+        {
+            olderThan[lowestSetBit(busy)] &= ~bit; // Stale bit from the slot's previous use
+        }
+        olderThan[s] = busyMask();
+        freeMask &= ~bit;
+        return base + s;
+    }
+
+    void release(int s)
+    {
+        freeMask |= 1ULL << s;
+        executing &= ~(1ULL << s);
+    }
+
+    void releaseAll()
+    {
+        freeMask = size == 64 ? ~0ULL : (1ULL << size) - 1;
+        executing = 0;
+    }
+
+    // Oldest station in ready, or -1: the one with no older station also ready
+    int selectOldest(uint64_t ready) const
+    {
+        for (uint64_t candidates = ready; candidates != 0; candidates &= candidates - 1)
+        {
+            int s = lowestSetBit(candidates);
+            if ((ready & olderThan[s]) == 0)
+            {
+                return s;
+            }
+        }
+        return -1;
+    }
+};
+
+// Reservation stations kept as parallel arrays so a CDB broadcast is one vector
+// compare of the tag against every Qj/Qk lane instead of a loop over structs
+struct ReservationStations
+{
+    static constexpr int LANES = 4;    // 32-bit lanes per SSE2 register
+    static constexpr int NO_TAG = -1;   // Operand value is present
+    static constexpr int PAD_TAG = -2;  // Padding lanes never match a broadcast
+
+    int count = 0;                // Number of stations
+    std::array<StationPool, RS_CLASS_COUNT> pools; // Stations grouped by functional unit class
+    std::vector<RSClass> stationClass; // Pool each station belongs to
+    std::vector<Opcode> op;            // Operation type
+    std::vector<int> Vj, Vk;           // Values of source operands
+    std::vector<int> Qj, Qk;           // Tags for source operands (dependency management)
+    std::vector<int> result;           // Computed result
+    std::vector<int> cyclesLeft;       // Remaining execution cycles
+    std::vector<int> address;          // For LOAD/STORE operations
+    std::vector<int> robIndex;         // Associated ROB entry
+    std::vector<long long> completionCycle; // Cycle in which execution finishes, -1 until started
+    std::vector<uint64_t> busy;        // Bit per station: allocated to an instruction
+    std::vector<uint64_t> resultReady; // Bit per station: result waiting for the write stage
+    std::vector<uint64_t> woken;       // Bit per station: an operand matched the last broadcast
+
+    void resize(const RSClassTable &stationsPerClass)
+    {
+        int stations = 0;
+        stationClass.clear();
+        for (int c = 0; c < RS_CLASS_COUNT; ++c)
+        {
+            pools[c].base = stations;
+            pools[c].size = stationsPerClass[c];
+            pools[c].releaseAll();
+            stations += stationsPerClass[c];
+            stationClass.insert(stationClass.end(), stationsPerClass[c], (RSClass)c);
+        }
+
+        count = stations;
+        int lanes = (stations + LANES - 1) / LANES * LANES;
+        op.assign(stations, OP_INVALID);
+        Vj.assign(lanes, 0);
+        Vk.assign(lanes, 0);
+        Qj.assign(lanes, (int)PAD_TAG);
+        Qk.assign(lanes, (int)PAD_TAG);
+        result.assign(stations, 0);
+        cyclesLeft.assign(stations, 0);
+        address.assign(stations, 0);
+        robIndex.assign(stations, -1);
+        completionCycle.assign(stations, -1);
+        busy.assign((stations + 63) / 64, 0);
+        resultReady.assign(busy.size(), 0);
+        woken.assign(busy.size(), 0);
+    }
+
+    static bool test(const std::vector<uint64_t> &mask, int i) { return (mask[i >> 6] >> (i & 63)) & 1; }
+    static void set(std::vector<uint64_t> &mask, int i) { mask[i >> 6] |= 1ULL << (i & 63); }
+    static void clear(std::vector<uint64_t> &mask, int i) { mask[i >> 6] &= ~(1ULL << (i & 63)); }
+
+    bool isBusy(int i) const { return test(busy, i); }
+    bool isResultReady(int i) const { return test(resultReady, i); }
+
+    // Returns a free station of the class, or -1 if the pool is exhausted
+    int allocate(RSClass rsClass)
+    {
+        StationPool &pool = pools[rsClass];
+        if (pool.freeMask == 0)
+        {
+            return -1;
+        }
+        int i = pool.allocate();
+        set(busy, i);
+        return i;
+    }
+
+    void release(int i)
+    {
+        StationPool &pool = pools[stationClass[i]];
+        pool.release(i - pool.base);
+        clear(busy, i);
+        clear(resultReady, i);
+        robIndex[i] = -1;
+    }
+
+    void releaseAll()
+    {
+        for (auto &pool : pools)
+        {
+            pool.releaseAll();
+        }
+        std::fill(busy.begin(), busy.end(), 0);
+        std::fill(resultReady.begin(), resultReady.end(), 0);
+    }
+
+    // Wakes every operand waiting on tag: Q == tag takes value and clears its tag.
+    // Returns the stations whose Qj or Qk matched, one bit per station
+    const std::vector<uint64_t> &broadcast(int tag, int value)
+    {
+        int lanes = (int)Qj.size();
+        std::fill(woken.begin(), woken.end(), 0);
+#if defined(__SSE2__) || defined(_M_X64)
+        const __m128i tags = _mm_set1_epi32(tag);
+        const __m128i values = _mm_set1_epi32(value);
+        for (int i = 0; i < lanes; i += LANES)
+        {
+            __m128i qj = _mm_loadu_si128((const __m128i *)&Qj[i]);
+            __m128i qk = _mm_loadu_si128((const __m128i *)&Qk[i]);
+            __m128i matchJ = _mm_cmpeq_epi32(qj, tags);
+            __m128i matchK = _mm_cmpeq_epi32(qk, tags);
+
+            // Matching lanes become NO_TAG (all ones) and take the broadcast value
+            _mm_storeu_si128((__m128i *)&Qj[i], _mm_or_si128(qj, matchJ));
+            _mm_storeu_si128((__m128i *)&Qk[i], _mm_or_si128(qk, matchK));
+            __m128i vj = _mm_loadu_si128((const __m128i *)&Vj[i]);
+            __m128i vk = _mm_loadu_si128((const __m128i *)&Vk[i]);
+            _mm_storeu_si128((__m128i *)&Vj[i], _mm_or_si128(_mm_and_si128(matchJ, values), _mm_andnot_si128(matchJ, vj)));
+            _mm_storeu_si128((__m128i *)&Vk[i], _mm_or_si128(_mm_and_si128(matchK, values), _mm_andnot_si128(matchK, vk)));
+
+            // One bit per lane; a group of LANES never straddles two mask words
+            uint64_t matched = (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_or_si128(matchJ, matchK)));
+            woken[i >> 6] |= matched << (i & 63);
+        }
+#else
+        // Branch-free so the compiler can vectorize it for other targets
+        for (int i = 0; i < lanes; ++i)
+        {
+            bool matchJ = Qj[i] == tag;
+            bool matchK = Qk[i] == tag;
+            Vj[i] = matchJ ? value : Vj[i];
+            Qj[i] = matchJ ? (int)NO_TAG : Qj[i];
+            Vk[i] = matchK ? value : Vk[i];
+            Qk[i] = matchK ? (int)NO_TAG : Qk[i];
+            woken[i >> 6] |= (uint64_t)(matchJ | matchK) << (i & 63);
+        }
+#endif
+        return woken;
+    }
+};
+
+// Scheduled end of execution for a reservation station
+struct CompletionEvent
+{
+    long long cycle; // Cycle in which the station finishes executing
+    int station;     // Index into reservationStations, or -1 when a functional unit frees up instead
+
+    bool operator>(const CompletionEvent &other) const { return cycle > other.cycle; }
+};
+
+enum ROBState : uint8_t
+{
+    ROB_EMPTY,
+    ROB_ISSUE,
+    ROB_EXECUTE,
+    ROB_WRITE,
+    ROB_COMMIT
+};
+
+const char *const robStateNames[] = {"Empty", "Issue", "Execute", "Write", "Commit"};
+
+// Record of one dynamic instruction, from issue until it commits or is squashed. Records live
+// in the reorder buffer's fixed ring and are reset in place when recycled, so issuing allocates
+// nothing; per-instance timing belongs here rather than on the static instruction.
+struct ROBEntry
+{
+    long long sequence = -1;   // Dynamic instruction number, in issue order
+    int instructionID = -1;    // ID of the instruction in the program
+    Opcode op = OP_INVALID;    // Decoded opcode of the instruction
+    ROBState state = ROB_EMPTY; // Pipeline state of the entry
+    int destination = -1;      // Register or memory address to write to
+    int value = 0;             // Computed value
+    bool ready = false;        // Whether the value is ready
+    bool speculative = false;  // Indicates if the instruction was executed speculatively
+    int pc = -1;               // Address the instruction was fetched from
+    int predictedNext = -1;    // Address fetch continued at after this instruction
+    bool predictedTaken = false; // Predicted BEQ direction
+    uint32_t history = 0;        // Predictor global history before this instruction issued
+    ReturnAddressStack::Checkpoint ras; // Return address stack before this instruction issued
+    int lsqIndex = -1;           // Load/store queue entry of a LOAD or STORE
+    int sourceTags[2] = {-1, -1};      // ROB entries the source operands waited for at issue, or -1
+    long long operandsReadyCycle = -1; // Cycle the last awaited operand was broadcast
+    int producerPc = -1;               // Instruction that broadcast it
+    InstructionProgress progress;      // Timing of this instance
+
+    // Issued with a source operand still being computed
+    bool waitedForOperands() const { return sourceTags[0] != -1 || sourceTags[1] != -1; }
+};
+
+// Circular reorder buffer: allocate at the tail, retire in order from the head. The ring is
+// sized once per configuration and is the only storage for in-flight instructions.
+struct ReorderBuffer
+{
+    std::vector<ROBEntry> entries;
+    int head = 0;  // Oldest in-flight entry
+    int tail = 0;  // Next entry to allocate
+    int count = 0; // Number of in-flight entries
+
+    explicit ReorderBuffer(int size) : entries(size) {}
+
+    int size() const { return (int)entries.size(); }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == size(); }
+    int next(int index) const { return index + 1 == size() ? 0 : index + 1; }
+
+    ROBEntry &operator[](int index) { return entries[index]; }
+    const ROBEntry &operator[](int index) const { return entries[index]; }
+
+    void resize(int size)
+    {
+        entries.assign(size, ROBEntry());
+        head = tail = count = 0;
+    }
+
+    // Returns the allocated index, or -1 if the buffer is full
+    int allocate()
+    {
+        if (full())
+        {
+            return -1;
+        }
+        int index = tail;
+        tail = next(tail);
+        count++;
+        return index;
+    }
+
+    // Frees the head entry so it can be reused
+    void retire()
+    {
+        entries[head] = ROBEntry();
+        head = next(head);
+        count--;
+    }
+
+    // Squashes every entry younger than index
+    void flushAfter(int index)
+    {
+        for (int i = next(index); i != tail; i = next(i))
+        {
+            entries[i] = ROBEntry();
+            count--;
+        }
+        tail = next(index);
+    }
+};
+
+// In-flight LOAD or STORE, in program order
+struct LSQEntry
+{
+    int robIndex = -1;         // Associated ROB entry
+    int station = -1;          // Reservation station computing the address and data
+    bool store = false;        // STORE rather than LOAD
+    bool addressKnown = false; // Effective address has been computed
+    int address = 0;           // Effective address
+    bool dataKnown = false;    // STORE: value to write is available
+    bool forwarded = false;    // LOAD: value comes from an older store, not memory
+    bool bypassed = false;     // LOAD: issued ahead of older stores to other addresses
+    int data = 0;              // STORE value, or the value forwarded to a LOAD
+};
+
+// Circular load/store queue: allocated at issue, retired at commit, so entries between
+// head and an index are exactly the older memory operations
+struct LoadStoreQueue
+{
+    std::vector<LSQEntry> entries;
+    int head = 0;
+    int tail = 0;
+    int count = 0;
+
+    int size() const { return (int)entries.size(); }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == size(); }
+    int next(int index) const { return index + 1 == size() ? 0 : index + 1; }
+    int prev(int index) const { return index == 0 ? size() - 1 : index - 1; }
+
+    LSQEntry &operator[](int index) { return entries[index]; }
+    const LSQEntry &operator[](int index) const { return entries[index]; }
+
+    void resize(int size)
+    {
+        entries.assign(size, LSQEntry());
+        clear();
+    }
+
+    void clear()
+    {
+        std::fill(entries.begin(), entries.end(), LSQEntry());
+        head = tail = count = 0;
+    }
+
+    int allocate()
+    {
+        int index = tail;
+        tail = next(tail);
+        count++;
+        return index;
+    }
+
+    void retire()
+    {
+        entries[head] = LSQEntry();
+        head = next(head);
+        count--;
+    }
+};
+
+// Word-addressed data memory as a two-level page table. A fixed directory points to
+// page tables, which point to 4K-word pages allocated on first store; absent pages read as 0.
+class PagedMemory
+{
+public:
+    static constexpr int PAGE_BITS = 12;
+    static constexpr int TABLE_BITS = 10;
+    static constexpr int PAGE_WORDS = 1 << PAGE_BITS;
+    static constexpr int TABLE_PAGES = 1 << TABLE_BITS;
+    static constexpr int DIRECTORY_TABLES = 1 << (32 - PAGE_BITS - TABLE_BITS);
+
+    PagedMemory() = default;
+    PagedMemory(const PagedMemory &other) { *this = other; }
+    PagedMemory(PagedMemory &&) = default;
+    PagedMemory &operator=(PagedMemory &&) = default;
+
+    // Deep copy, so every simulator gets a private image
+    PagedMemory &operator=(const PagedMemory &other)
+    {
+        if (this == &other)
+        {
+            return *this;
+        }
+        for (int t = 0; t < DIRECTORY_TABLES; ++t)
+        {
+            directory[t].reset();
+            if (other.directory[t])
+            {
+                directory[t].reset(new PageTable());
+                for (int p = 0; p < TABLE_PAGES; ++p)
+                {
+                    if ((*other.directory[t])[p])
+                    {
+                        (*directory[t])[p].reset(new Page(*(*other.directory[t])[p]));
+                    }
+                }
+            }
+        }
+        return *this;
+    }
+
+    int read(int address) const
+    {
+        uint32_t a = (uint32_t)address;
+        const PageTable *table = directory[a >> (PAGE_BITS + TABLE_BITS)].get();
+        if (!table)
+        {
+            return 0;
+        }
+        const Page *page = (*table)[(a >> PAGE_BITS) & (TABLE_PAGES - 1)].get();
+        return page ? page->words[a & (PAGE_WORDS - 1)] : 0;
+    }
+
+    void write(int address, int value)
+    {
+        uint32_t a = (uint32_t)address;
+        std::unique_ptr<PageTable> &table = directory[a >> (PAGE_BITS + TABLE_BITS)];
+        if (!table)
+        {
+            table.reset(new PageTable());
+        }
+        std::unique_ptr<Page> &page = (*table)[(a >> PAGE_BITS) & (TABLE_PAGES - 1)];
+        if (!page)
+        {
+            page.reset(new Page());
+        }
+        int w = a & (PAGE_WORDS - 1);
+        page->words[w] = value;
+        page->written[w >> 6] |= 1ULL << (w & 63);
+    }
+
+    void clear()
+    {
+        for (auto &table : directory)
+        {
+            table.reset();
+        }
+    }
+
+    // Visits only the words that have been written, in ascending unsigned address order,
+    // skipping absent tables and pages without touching them
+    class const_iterator
+    {
+    public:
+        const_iterator(const PagedMemory *memory, uint64_t address) : memory(memory), address(address) { seek(); }
+
+        std::pair<int, int> operator*() const { return {(int)address, memory->read((int)address)}; }
+        const_iterator &operator++()
+        {
+            address++;
+            seek();
+            return *this;
+        }
+        bool operator==(const const_iterator &other) const { return address == other.address; }
+        bool operator!=(const const_iterator &other) const { return address != other.address; }
+
+    private:
+        const PagedMemory *memory;
+        uint64_t address; // END once past the last written word
+
+        // Moves address forward to the next written word
+        void seek()
+        {
+            while (address < END)
+            {
+                const PageTable *table = memory->directory[address >> (PAGE_BITS + TABLE_BITS)].get();
+                if (!table)
+                {
+                    address = ((address >> (PAGE_BITS + TABLE_BITS)) + 1) << (PAGE_BITS + TABLE_BITS);
+                    continue;
+                }
+                const Page *page = (*table)[(address >> PAGE_BITS) & (TABLE_PAGES - 1)].get();
+                int w = address & (PAGE_WORDS - 1);
+                uint64_t bits = page ? page->written[w >> 6] & (~0ULL << (w & 63)) : 0;
+                if (bits != 0)
+                {
+                    address = (address & ~63ULL) + lowestSetBit(bits);
+                    return;
+                }
+                address = page ? (address | 63) + 1 : ((address >> PAGE_BITS) + 1) << PAGE_BITS;
+            }
+        }
+    };
+
+    static constexpr uint64_t END = 1ULL << 32;
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, END); }
+
+private:
+    struct Page
+    {
+        std::array<int, PAGE_WORDS> words{};
+        std::array<uint64_t, PAGE_WORDS / 64> written{}; // Bit set = word stored at least once
+    };
+    using PageTable = std::array<std::unique_ptr<Page>, TABLE_PAGES>;
+
+    std::array<std::unique_ptr<PageTable>, DIRECTORY_TABLES> directory;
+};
+
+// Which finished results win the common data buses when more are ready than there are buses
+enum CDBArbitration
+{
+    CDB_OLDEST_FIRST,  // Oldest instruction in program order first
+    CDB_UNIT_PRIORITY, // Functional units in RSClass order, oldest first within a class
+    CDB_ARBITRATION_COUNT
+};
+
+const char *const cdbArbitrationNames[] = {"oldest-first", "unit-priority"};
+
+// Sizes and latencies of the simulated machine
+struct HardwareConfig
+{
+    RSClassTable stations = defaultReservationStations(); // Reservation stations per class
+    int robEntries = 6;                                   // ROB with 6 entries
+    OpTable cycles = defaultOperationCycles();            // Execution cycles per opcode
+    RSClassTable units = uniformRSClassTable(1);          // Functional units per class
+    RSClassTable intervals = uniformRSClassTable(1);      // Initiation interval per class, 0 = unpipelined
+    int issueWidth = 1;                                   // Instructions issued per cycle
+    int commitWidth = 1;                                  // Instructions retired per cycle
+    int cdbWidth = 0;                                     // Results broadcast per cycle, 0 = unlimited
+    CDBArbitration cdbArbitration = CDB_OLDEST_FIRST;     // Which results get a bus when too many are ready
+    PredictorKind predictor = PREDICTOR_NOT_TAKEN;        // BEQ direction predictor
+    int predictorBits = 10;                               // log2 of the predictor table sizes
+    int btbEntries = 0;                                   // Branch target buffer entries, 0 = no BTB
+    int rasDepth = 0;                                     // Return address stack entries, 0 = no RAS
+    int lsqEntries = 8;                                   // Loads and stores in flight
+};
+
+// Common data bus counters; results that lose arbitration stay in their station and retry
+struct CDBStats
+{
+    long long broadcasts = 0;       // Results written
+    long long saturatedCycles = 0;  // Cycles in which every bus carried a result
+    long long contentionCycles = 0; // Cycles in which a finished result waited for a bus
+    long long deferredResults = 0;  // Cycles spent waiting for a bus, summed over results
+};
+
+// What an issue or commit slot did in a cycle. An unused commit slot is charged to whatever
+// holds up the oldest instruction; an unused issue slot to whatever stopped issue.
+enum SlotClass : uint8_t
+{
+    SLOT_USEFUL,        // Issued or committed an instruction
+    SLOT_ROB_FULL,      // Issue: no free ROB entry
+    SLOT_STATION_FULL,  // Issue: no free station in the instruction's class
+    SLOT_OPERAND_WAIT,  // Commit: the oldest instruction issued waiting for a source operand
+    SLOT_EXECUTION,     // Commit: the oldest instruction issued ready and executes or waits for a unit
+    SLOT_MEMORY,        // Issue: load/store queue full; commit: the oldest instruction is a LOAD or STORE in flight
+    SLOT_CDB,           // Commit: the oldest instruction's result waits for a bus
+    SLOT_BRANCH_FLUSH,  // Wrong-path issue, or an empty ROB after a misprediction
+    SLOT_FRONT_END,     // Fetch stopped at a taken transfer, ran out of program, or has not started
+    SLOT_CLASS_COUNT
+};
+
+const char *const slotClassNames[] = {"useful", "rob-full", "station-full", "operand-wait", "execution",
+                                      "memory", "cdb", "branch-flush", "front-end"};
+
+// Cycle accounting: slot classes summed over the run, and occupancy histograms sampled every cycle
+struct CycleAccounting
+{
+    std::array<long long, SLOT_CLASS_COUNT> issueSlots{};
+    std::array<long long, SLOT_CLASS_COUNT> commitSlots{};
+    std::array<long long, RS_CLASS_COUNT> stationFullSlots{}; // SLOT_STATION_FULL issue slots by class
+    std::vector<long long> robOccupancy;                      // Cycles with n entries in use, n = 0..robEntries
+    std::array<std::vector<long long>, RS_CLASS_COUNT> stationOccupancy; // Cycles with n stations busy
+};
+
+// Timing of one static instruction, summed over every committed execution of it
+struct PCProfile
+{
+    long long executions = 0;        // Commits
+    long long latencyCycles = 0;     // Issue to commit
+    long long operandWaitCycles = 0; // Issue until the last awaited operand was broadcast
+    long long taken = 0;             // BEQ only: taken commits
+    std::vector<std::pair<int, long long>> producers; // Operand wait cycles by the PC that ended them
+
+    // PC accounting for most of the operand wait, or -1
+    int mainProducer() const
+    {
+        int pc = -1;
+        long long most = 0;
+        for (const auto &producer : producers)
+        {
+            if (producer.second > most)
+            {
+                pc = producer.first;
+                most = producer.second;
+            }
+        }
+        return pc;
+    }
+};
+
+// Load/store queue counters
+struct MemoryStats
+{
+    long long forwardedLoads = 0; // LOADs served by an older STORE to the same address
+    long long bypassingLoads = 0; // LOADs issued to memory ahead of older, non-conflicting STOREs
+};
+
+// Control-flow prediction counters
+struct PredictionStats
+{
+    long long directionMisses = 0; // BEQs whose predicted direction was wrong
+    long long targetMisses = 0;    // CALL/RET that fetch did not follow to the right target
+    long long btbLookups = 0;      // Control instructions looked up at issue
+    long long btbHits = 0;
+    long long flushes = 0;         // Mispredictions that squashed the ROB behind them
+    long long flushCycles = 0;     // Cycles between issue and resolution of those mispredictions
+    long long rasOverflows = 0;    // CALLs that overwrote the oldest return address
+    long long rasUnderflows = 0;   // RETs issued with the return address stack empty
+};
+
+class TraceReader;
+class PipelineView;
+enum PipeEventKind : uint8_t;
+
+// Tomasulo core with a reorder buffer. Each instance owns its whole machine state,
+// so any number of simulations can run side by side in one process.
+class Simulator
+{
+public:
+    long long maxCycles = 100000000; // Guards against programs that never terminate
+    bool eventDriven = true;         // Skip cycles in which stations only count down
+    bool detailedStats = true;       // Keep the CPI stack, occupancy histograms and per-PC profile
+
+    // Resets the machine and loads a decoded program, an initial memory image and a configuration;
+    // sizes outside what the core supports (e.g. more than 64 stations per class) are clamped
+    void load(const std::vector<Instruction> &program, const PagedMemory &memoryImage,
+              const HardwareConfig &config = HardwareConfig(), int startingAddress = 0);
+
+    // Resets the machine to replay a trace instead of a program; the reader must outlive the run
+    void loadTrace(TraceReader &source, const HardwareConfig &config = HardwareConfig());
+
+    // Advances up to n cycles; returns the number simulated (fewer once the program finishes)
+    int step(int n = 1);
+
+    // Runs until predicate(*this) holds after a cycle, or the program finishes
+    void runUntil(const std::function<bool(const Simulator &)> &predicate);
+
+    // Runs to completion or the cycle limit
+    void run();
+
+    // Squashes everything in flight, then executes up to n instructions architecturally with no
+    // timing, training the branch predictor, BTB and RAS on the way. Returns the number executed.
+    long long fastForward(long long n);
+
+    bool finished() const;
+    void displayMetrics() const;
+
+    // Annotated listing of the program with per-instruction counts, latencies and stalls
+    void displayProfile() const;
+
+    // Read-only view of the machine
+    long long cycles() const { return totalCycles; }
+    int programCounter() const { return pc; }
+    long long committedInstructions() const { return instructionsCompleted; }
+    long long fastForwardedInstructions() const { return fastForwarded; }
+    long long branches() const { return totalBranches; }
+    long long mispredictions() const { return branchMispredictions; }
+    const PredictionStats &predictionStats() const { return prediction; }
+    const MemoryStats &memoryStats() const { return memoryCounters; }
+    const CDBStats &cdbStats() const { return cdbCounters; }
+    const CycleAccounting &cycleAccounting() const { return accounting; }
+    const std::vector<PCProfile> &profile() const { return pcProfile; }
+    double ipc() const { return totalCycles > 0 ? (double)instructionsCompleted / totalCycles : 0.0; }
+    const HardwareConfig &config() const { return hardware; }
+    const std::vector<Instruction> &program() const { return instructions; }
+    const std::vector<int> &registerFile() const { return registers; }
+    const PagedMemory &memoryState() const { return memory; }
+    const ReorderBuffer &rob() const { return reorderBuffer; }
+    const ReservationStations &stations() const { return reservationStations; }
+
+    // Streams every issue, execute, write, commit and squash to view; null stops it
+    void attachPipeView(PipelineView *view) { pipeview = view; }
+
+private:
+    HardwareConfig hardware;
+    ReorderBuffer reorderBuffer = ReorderBuffer(6);
+    std::vector<Instruction> instructions;
+    OpTable operationCycles = defaultOperationCycles();
+
+    std::vector<int> registers = std::vector<int>(8, 0);
+    std::vector<int> registerStatus = std::vector<int>(8, -1); // ROB entry that will write each register, or -1 if the register file is current
+
+    PagedMemory memory;
+    ReservationStations reservationStations;
+    LoadStoreQueue loadStoreQueue;
+    MemoryStats memoryCounters;
+
+    long long totalCycles = 0;
+    long long instructionsCompleted = 0;
+    long long branchMispredictions = 0;
+    long long totalBranches = 0;
+    long long fastForwarded = 0; // Instructions executed by fastForward, not counted as committed
+    int pc = 0;
+    bool activity = false; // Whether any stage made progress this cycle
+
+    std::unique_ptr<BranchPredictor> predictor = makePredictor(PREDICTOR_NOT_TAKEN, 0);
+    BranchTargetBuffer btb;
+    ReturnAddressStack ras;
+    PredictionStats prediction;
+
+    TraceReader *trace = nullptr; // Instruction source in trace-driven mode, else null
+    bool redirectPending = false; // Trace mode: issue waits for a control transfer to commit
+
+    std::vector<int> cdbRequests; // Scratch list of stations competing for the CDB
+    CDBStats cdbCounters;
+
+    CycleAccounting accounting;
+    std::vector<PCProfile> pcProfile; // Indexed by PC
+    SlotClass issueStall = SLOT_FRONT_END;  // Why issue stopped in the last cycle
+    RSClass stalledClass = RS_LOAD;         // Station class issue waited for, with SLOT_STATION_FULL
+    SlotClass commitStall = SLOT_FRONT_END; // Why commit stopped in the last cycle
+
+    PipelineView *pipeview = nullptr; // Pipeline event sink, or null
+    long long sequence = 0;           // Dynamic instructions issued so far
+
+    // Per functional unit: first cycle in which it accepts another operation
+    std::array<std::vector<long long>, RS_CLASS_COUNT> unitFreeCycle;
+
+    // Pending completions, earliest first; entries for flushed stations are dropped lazily
+    std::priority_queue<CompletionEvent, std::vector<CompletionEvent>, std::greater<CompletionEvent>> completionEvents;
+
+    void initialize();
+    void advance(long long lastCycle);
+    template <bool Detailed> void cycle(long long lastCycle);
+    bool issueFromProgram();
+    bool issueFromTrace();
+    int predictNext(const Instruction &instr, ROBEntry &entry);
+    int issue(const Instruction &instr, ReservationStations &reservationStations, ReorderBuffer &reorderBuffer);
+    template <bool Detailed> int commit(ReservationStations &reservationStations, ReorderBuffer &rob);
+    template <bool Detailed> bool commitHead(ReservationStations &reservationStations, ReorderBuffer &rob);
+    template <bool Detailed> void write(ReservationStations &reservationStations, ReorderBuffer &reorderBuffer);
+    void execute(ReservationStations &reservationStations, ReorderBuffer &rob);
+    bool fetchDone() const;
+    bool allInstructionsCompleted() const;
+    SlotClass classifyCommitStall(const ReservationStations &rs, const ReorderBuffer &rob) const;
+    void accountCycles(int issued, int committed, long long cycles);
+    void displayAccounting() const;
+    void profileCommit(const ROBEntry &entry);
+    template <bool Detailed> void handleBranch(ReservationStations &reservationStations, ReorderBuffer &rob, int target);
+    template <bool Detailed> void skipToNextEvent(ReservationStations &reservationStations, long long lastCycle);
+    void dumpState(const ReservationStations &rs, const ReorderBuffer &rob) const;
+    void finishExecution(ReservationStations &rs, ReorderBuffer &rob, int i);
+    void computeAddresses(const ReservationStations &rs);
+    bool resolveLoad(const ReservationStations &rs, const ReorderBuffer &rob, int i);
+    void dispatch(ReservationStations &rs, ReorderBuffer &rob, int i, long long &unitFree);
+    void readOperand(int reg, int &value, int &tag, const ReorderBuffer &rob);
+    void tracePipeline(PipeEventKind kind, const ROBEntry &entry);
+};
+
+Opcode decodeOpcode(const std::string &mnemonic);
+void loadMemoryFromFile(PagedMemory &memory, const std::string &filename);
+void loadInstructionsFromFile(std::vector<Instruction> &instructions, const std::string &filename);
+
+#endif
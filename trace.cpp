@@ -0,0 +1,135 @@
+#include "trace.h"
+#include "interpreter.h"
+#include <cstring>
+
+using namespace std;
+
+TraceReader::~TraceReader()
+{
+    if (ahead.valid())
+    {
+        ahead.wait(); // The reader thread still writes into blocks
+    }
+}
+
+bool TraceReader::open(const string &filename)
+{
+    file.open(filename, ios::binary);
+    TraceHeader header;
+    if (!file || !file.read((char *)&header, sizeof(header)) ||
+        memcmp(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) != 0 || header.version != TRACE_VERSION)
+    {
+        cerr << "Error: Could not open trace file!" << endl;
+        return false;
+    }
+
+    // Read the first block now and start on the second
+    current = 1;
+    fill(blocks[0]);
+    advance();
+    LOG(LOG_SUMMARY, "Trace opened successfully from file: " << filename << endl);
+    return true;
+}
+
+void TraceReader::pop()
+{
+    records++;
+    if (++position == blocks[current].size())
+    {
+        advance();
+    }
+}
+
+void TraceReader::fill(vector<TraceRecord> &block)
+{
+    block.resize(BLOCK_RECORDS); // Capacity is kept, so only the first fill allocates
+    file.read((char *)block.data(), BLOCK_RECORDS * sizeof(TraceRecord));
+    block.resize(file.gcount() / sizeof(TraceRecord)); // A truncated last record is dropped
+}
+
+// Switches to the block read in the background and starts reading the one after it
+void TraceReader::advance()
+{
+    if (ahead.valid())
+    {
+        ahead.get();
+    }
+    current ^= 1;
+    position = 0;
+
+    if (!blocks[current].empty())
+    {
+        vector<TraceRecord> &next = blocks[current ^ 1];
+        ahead = async(launch::async, [this, &next]()
+                      { fill(next); });
+    }
+}
+
+bool decodeTraceRecord(const TraceRecord &record, Instruction &instr)
+{
+    if (record.op >= OP_COUNT || record.rA >= 8 || record.rB >= 8 || record.rC >= 8)
+    {
+        return false;
+    }
+
+    instr.op = (Opcode)record.op;
+    instr.rA = record.rA;
+    instr.rB = record.rB;
+    instr.rC = record.rC;
+    instr.imm = record.imm;
+    instr.offset = record.address; // Memory operations use the recorded address as is
+    instr.target = record.address;
+    instr.taken = record.taken != 0;
+    instr.progress = InstructionProgress();
+    return true;
+}
+
+bool recordTrace(const vector<Instruction> &program, const PagedMemory &memoryImage, int startingAddress,
+                 const string &filename, long long maxInstructions)
+{
+    ofstream traceFile(filename, ios::binary);
+    if (!traceFile)
+    {
+        cerr << "Error: Could not open trace file!" << endl;
+        return false;
+    }
+
+    TraceHeader header = {};
+    memcpy(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    header.version = TRACE_VERSION;
+    traceFile.write((const char *)&header, sizeof(header));
+
+    // Same initial machine state as Simulator::initialize
+    PagedMemory memory = memoryImage;
+    vector<int> registers(8, 0);
+    registers[6] = 4;
+
+    long long count = 0;
+    for (int pc = startingAddress; pc >= 0 && pc < (int)program.size() && count < maxInstructions; ++count)
+    {
+        const Instruction &instr = program[pc];
+
+        TraceRecord record = {};
+        record.pc = pc;
+        record.op = (uint8_t)instr.op;
+        record.rA = (uint8_t)instr.rA;
+        record.rB = (uint8_t)instr.rB;
+        record.rC = (uint8_t)instr.rC;
+        record.imm = instr.imm;
+
+        Outcome outcome = executeInstruction(instr, pc, registers, memory);
+        record.address = outcome.address;
+        record.taken = outcome.taken;
+
+        traceFile.write((const char *)&record, sizeof(record));
+        pc = outcome.next;
+    }
+
+    if (!traceFile)
+    {
+        cerr << "Error: Could not write trace file!" << endl;
+        return false;
+    }
+    LOG(LOG_SUMMARY, "Recorded " << count << " instructions into trace: " << filename << endl);
+    return true;
+}
@@ -0,0 +1,74 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "tomasulo.h"
+#include <fstream>
+#include <future>
+
+// One committed dynamic instruction with its memory address and control outcome resolved
+struct TraceRecord
+{
+    int32_t pc;      // Address of the instruction in the program
+    uint8_t op;      // Opcode
+    uint8_t rA;      // Registers
+    uint8_t rB;
+    uint8_t rC;
+    int32_t imm;     // Immediate value
+    int32_t address; // Effective address for LOAD/STORE, target for BEQ/CALL/RET
+    uint8_t taken;   // BEQ outcome
+    uint8_t reserved[3];
+};
+
+static_assert(sizeof(TraceRecord) == 20, "Trace records are 20 bytes wide");
+
+// Start of a trace file; records follow until end of file. All fields are in host byte order.
+struct TraceHeader
+{
+    char magic[8];    // TRACE_MAGIC
+    uint32_t version; // TRACE_VERSION
+    uint32_t reserved;
+};
+
+const char TRACE_MAGIC[8] = {'T', 'O', 'M', 'A', 'S', 'T', 'R', 'C'};
+const uint32_t TRACE_VERSION = 1;
+
+// Streams a trace through two fixed blocks: the core consumes one while the next is
+// read in the background, so memory use does not grow with the trace length
+class TraceReader
+{
+public:
+    static constexpr size_t BLOCK_RECORDS = 16384;
+
+    TraceReader() = default;
+    ~TraceReader();
+    TraceReader(const TraceReader &) = delete;
+    TraceReader &operator=(const TraceReader &) = delete;
+
+    bool open(const std::string &filename);
+
+    // Next record, or nullptr once the trace is exhausted
+    const TraceRecord *peek() const { return exhausted() ? nullptr : &blocks[current][position]; }
+    void pop();
+    bool exhausted() const { return position >= blocks[current].size(); }
+    long long consumed() const { return records; }
+
+private:
+    std::ifstream file;
+    std::vector<TraceRecord> blocks[2];
+    int current = 0;         // Block being consumed
+    size_t position = 0;     // Next record in the current block
+    long long records = 0;   // Records consumed so far
+    std::future<void> ahead; // Read of the other block, if one is in flight
+
+    void fill(std::vector<TraceRecord> &block);
+    void advance();
+};
+
+// Fills instr from a record; false if the record is malformed
+bool decodeTraceRecord(const TraceRecord &record, Instruction &instr);
+
+// Runs a program functionally and writes its committed path as a trace
+bool recordTrace(const std::vector<Instruction> &program, const PagedMemory &memoryImage, int startingAddress,
+                 const std::string &filename, long long maxInstructions);
+
+#endif